@@ -39,10 +39,10 @@ class MainActivity : ComponentActivity() {
 
             override fun onPairTag(
                 tag: TagInfo,
-                openingTagStartIndex: Int,
-                openingTagEndIndex: Int,
-                closingTagStartIndex: Int,
-                closingTagEndIndex: Int
+                openingTagStartIndex: Long,
+                openingTagEndIndex: Long,
+                closingTagStartIndex: Long,
+                closingTagEndIndex: Long
             ): Boolean {
                 super.onPairTag(
                     tag = tag,
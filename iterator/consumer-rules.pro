@@ -0,0 +1,30 @@
+# Members used from native code by name, they must not be renamed nor removed.
+-keepclasseswithmembernames class com.htmliterator.HtmlIterator {
+    native <methods>;
+}
+-keepclassmembers class com.htmliterator.HtmlIterator {
+    long nativeHandle;
+}
+-keep class com.htmliterator.TagInfo {
+    private <init>(long, boolean, boolean);
+    private long nativeTag;
+}
+-keepclasseswithmembernames class com.htmliterator.TagInfo {
+    native <methods>;
+}
+-keep class com.htmliterator.HtmlIterator$Callback {
+    public void onContentText(java.lang.String);
+    public void onSingleTag(com.htmliterator.TagInfo);
+    public boolean onPairTag(com.htmliterator.TagInfo, long, long, long, long);
+    public void onLeavingPairTag(com.htmliterator.TagInfo, long, long);
+    public void onScript(com.htmliterator.TagInfo);
+}
+-keep interface com.htmliterator.HtmlIterator$CallbackFactory {
+    com.htmliterator.HtmlIterator$Callback createCallback(int);
+}
+-keep class com.htmliterator.EventBatchDecoder {
+    public void onEvents(java.nio.ByteBuffer, int, int);
+}
+-keep interface com.htmliterator.HtmlIterator$SelectorCallback {
+    void onMatch(com.htmliterator.TagInfo, int, long, long);
+}
@@ -0,0 +1,72 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.util.concurrent.atomic.AtomicReferenceArray
+
+
+/**
+ * Checks that every document iterated by [HtmlIterator.iterateBatch] delivers the same steps to its
+ * callback as the same document iterated alone.
+ */
+@RunWith(AndroidJUnit4::class)
+class BatchIterationTest : BaseAndroidTest() {
+
+
+    data object Results {
+        const val COPIES_COUNT: Int = 25
+        val FILE_NAMES: List<String> = listOf(
+            "full-doc-test1.html",
+            "full-doc-test2.html",
+            "pair-tag-matching-test.html",
+            "tag-info-test.html",
+        )
+    }
+
+
+    @Test
+    fun checkBatchSteps() {
+        val documents = List(size = Results.COPIES_COUNT) { Results.FILE_NAMES }
+            .flatten()
+            .map { fileName -> loadAsset(fileName = fileName) }
+
+        val expectedSteps = documents.map { document ->
+            val callback = StreamingInputTest.StreamingInputTestCallback()
+            iterator.setCallback(callback = callback)
+            iterator.setContent(content = document)
+            iterator.iterate()
+            callback.steps
+        }
+
+        val callbacks = AtomicReferenceArray<StreamingInputTest.StreamingInputTestCallback>(
+            documents.size
+        )
+        iterator.iterateBatch(documents = documents) { documentIndex ->
+            StreamingInputTest.StreamingInputTestCallback().also { callback ->
+                callbacks.set(documentIndex, callback)
+            }
+        }
+
+        expectedSteps.forEachIndexed { index, steps ->
+            assertEquals(
+                actual = callbacks.get(index)?.steps == steps,
+                expected = true,
+                message = { "Steps differ for document $index" },
+            )
+        }
+    }
+
+
+    @Test(expected = IllegalStateException::class)
+    fun checkCallbackException() {
+        val documents = List(size = Results.COPIES_COUNT) { "<div><p>text</p></div>" }
+        iterator.iterateBatch(documents = documents) {
+            object : HtmlIterator.Callback() {
+                override fun onContentText(text: String) {
+                    throw IllegalStateException("Callback failed")
+                }
+            }
+        }
+    }
+}
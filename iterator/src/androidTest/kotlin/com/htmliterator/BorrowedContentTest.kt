@@ -0,0 +1,68 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.nio.ByteBuffer
+
+
+/**
+ * Checks that content borrowed from direct [ByteBuffer] or [ByteArray] delivers the same steps as
+ * the same content copied into [ByteArray] without offset.
+ */
+@RunWith(AndroidJUnit4::class)
+class BorrowedContentTest : BaseAndroidTest() {
+
+
+    @Test
+    fun checkDirectBuffer() {
+        checkBorrowedContent(fileName = "full-doc-test1.html") { bytes ->
+            val buffer = ByteBuffer.allocateDirect(bytes.size + 2)
+            //Content is placed between position and limit, not at the start of the buffer
+            buffer.put(' '.code.toByte())
+            buffer.put(bytes)
+            buffer.flip()
+            buffer.position(1)
+            iterator.setContent(buffer = buffer)
+        }
+    }
+
+
+    @Test
+    fun checkByteArray() {
+        checkBorrowedContent(fileName = "full-doc-test1.html") { bytes ->
+            val paddedBytes = ByteArray(size = 1) + bytes + ByteArray(size = 1)
+            iterator.setContent(bytes = paddedBytes, offset = 1, length = bytes.size)
+        }
+    }
+
+
+    @Test(expected = IllegalArgumentException::class)
+    fun checkHeapBuffer() {
+        iterator.setContent(buffer = ByteBuffer.allocate(16))
+    }
+
+
+    private fun checkBorrowedContent(
+        fileName: String,
+        setBorrowedContent: (bytes: ByteArray) -> Unit,
+    ) {
+        val content = loadAsset(fileName = fileName)
+        val expectedCallback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = expectedCallback)
+        //String content is indexed by UTF-16 chars, so UTF-8 bytes are expected
+        iterator.setContent(bytes = content.toByteArray(charset = Charsets.UTF_8))
+        iterator.iterate()
+
+        val callback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = callback)
+        setBorrowedContent(content.toByteArray(charset = Charsets.UTF_8))
+        iterator.iterate()
+
+        assertEquals(
+            actual = callback.steps == expectedCallback.steps,
+            expected = true,
+            message = { "Steps differ for borrowed $fileName" },
+        )
+    }
+}
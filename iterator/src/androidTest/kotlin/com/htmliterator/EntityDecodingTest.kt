@@ -0,0 +1,103 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that character references are decoded in texts and attribute values of both UTF-16 and
+ * UTF-8 content, while '&' which doesn't start a reference is kept.
+ */
+@RunWith(AndroidJUnit4::class)
+class EntityDecodingTest : BaseAndroidTest() {
+
+
+    data object Results {
+        const val CONTENT: String = "<p title=\"Tom &amp; Jerry\">Tom &amp; Jerry&nbsp;&mdash; " +
+                "caf&eacute; &#x1F40E; &#8212; AT&T &lt;b&gt;</p>" +
+                "<a href=\"/search?q=1&copy=2&amp;lang=en\">link</a>"
+
+        val TEXTS: List<String> = listOf("Tom & Jerry\u00A0— café 🐎 — AT&T <b>", "link")
+
+        const val TITLE: String = "Tom & Jerry"
+
+        const val HREF: String = "/search?q=1&copy=2&lang=en"
+
+        const val UTF8_CONTENT: String = "<p>caf&eacute; &mdash; &#x10D;</p>"
+
+        val UTF8_TEXTS: List<String> = listOf("café — č")
+    }
+
+
+    /**
+     * Collects texts and attributes of all pair tags.
+     */
+    class EntityDecodingTestCallback : HtmlIterator.Callback() {
+        val texts: MutableList<String> = mutableListOf()
+        val attributes: MutableMap<String, String> = mutableMapOf()
+
+        override fun onContentText(text: String) {
+            super.onContentText(text = text)
+            texts.add(element = text)
+        }
+
+        override fun onPairTag(
+            tag: TagInfo,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ): Boolean {
+            super.onPairTag(
+                tag = tag,
+                openingTagStartIndex = openingTagStartIndex,
+                openingTagEndIndex = openingTagEndIndex,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            attributes.putAll(from = tag.attributes)
+            return true
+        }
+    }
+
+
+    @Test
+    fun checkDecodedTextsAndAttributes() {
+        val callback = EntityDecodingTestCallback()
+        iterator.setCallback(callback = callback)
+        iterator.setContent(content = Results.CONTENT)
+        iterator.iterate()
+
+        assertEquals(
+            actual = callback.texts == Results.TEXTS,
+            expected = true,
+            message = { "Texts differ: ${callback.texts}" },
+        )
+        assertEquals(
+            actual = callback.attributes["title"] == Results.TITLE,
+            expected = true,
+            message = { "Title differs: ${callback.attributes["title"]}" },
+        )
+        assertEquals(
+            actual = callback.attributes["href"] == Results.HREF,
+            expected = true,
+            message = { "Href differs: ${callback.attributes["href"]}" },
+        )
+    }
+
+
+    @Test
+    fun checkDecodedUtf8Texts() {
+        val callback = EntityDecodingTestCallback()
+        iterator.setCallback(callback = callback)
+        iterator.setContent(bytes = Results.UTF8_CONTENT.encodeToByteArray())
+        iterator.iterate()
+
+        assertEquals(
+            actual = callback.texts == Results.UTF8_TEXTS,
+            expected = true,
+            message = { "Texts differ: ${callback.texts}" },
+        )
+    }
+}
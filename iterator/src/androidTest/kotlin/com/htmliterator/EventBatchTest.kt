@@ -0,0 +1,162 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that callback set by [HtmlIterator.setBatchedCallback] gets the same steps as callback set
+ * by [HtmlIterator.setCallback], for batches of any size.
+ */
+@RunWith(AndroidJUnit4::class)
+class EventBatchTest : BaseAndroidTest() {
+
+
+    data object Results {
+        val FILE_NAMES: List<String> = listOf(
+            "full-doc-test1.html",
+            "full-doc-test2.html",
+            "kotlin-integration-test.html",
+            "pair-tag-matching-test.html",
+            "tag-info-test.html",
+        )
+        val MAX_EVENTS_COUNTS: List<Int> = listOf(1, 7, 1000)
+        val REFUSING_CONTENTS: List<String> = listOf(
+            "<div><ul><li>a</li><li>b</li></ul><p>after</p><ul><li>c</li></ul><p>end</p></div>",
+            //Refused tag without text at its end, following text belongs to the parent
+            "<section><ul><b>x</b></ul>after<p>y</p></section>",
+        )
+        const val CHUNK_SIZE: Int = 64
+    }
+
+
+    /**
+     * Refuses to step into every &lt;ul&gt; tag.
+     */
+    class RefusingCallback : HtmlIterator.Callback() {
+        val steps: MutableList<String> = mutableListOf()
+
+        override fun onContentText(text: String) {
+            steps.add(element = "text $text")
+        }
+
+        override fun onPairTag(
+            tag: TagInfo,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ): Boolean {
+            super.onPairTag(
+                tag = tag,
+                openingTagStartIndex = openingTagStartIndex,
+                openingTagEndIndex = openingTagEndIndex,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            steps.add(element = "pair ${tag.tag}")
+            return tag.tag != "ul"
+        }
+
+        override fun onLeavingPairTag(tag: TagInfo) {
+            super.onLeavingPairTag(tag = tag)
+            steps.add(element = "leaving ${tag.tag}")
+        }
+    }
+
+
+    @Test
+    fun checkStringContent() {
+        Results.FILE_NAMES.forEach { fileName ->
+            val content = loadAsset(fileName = fileName)
+            checkSteps(fileName = fileName) { htmlIterator ->
+                htmlIterator.setContent(content = content)
+                htmlIterator.iterate()
+            }
+        }
+    }
+
+
+    @Test
+    fun checkBytesContent() {
+        Results.FILE_NAMES.forEach { fileName ->
+            val bytes = loadAsset(fileName = fileName).toByteArray(charset = Charsets.UTF_8)
+            checkSteps(fileName = fileName) { htmlIterator ->
+                htmlIterator.setContent(bytes = bytes)
+                htmlIterator.iterate()
+            }
+        }
+    }
+
+
+    @Test
+    fun checkStreamedContent() {
+        Results.FILE_NAMES.forEach { fileName ->
+            val chunks = loadAsset(fileName = fileName).chunked(size = Results.CHUNK_SIZE)
+            checkSteps(fileName = fileName) { htmlIterator ->
+                chunks.forEach { chunk -> htmlIterator.feed(chunk = chunk) }
+                htmlIterator.finish()
+            }
+        }
+    }
+
+
+    @Test
+    fun checkRefusedPairTag() {
+        Results.REFUSING_CONTENTS.forEach { content ->
+            val expectedCallback = RefusingCallback()
+            iterator.setCallback(callback = expectedCallback)
+            iterator.setContent(content = content)
+            iterator.iterate()
+
+            Results.MAX_EVENTS_COUNTS.forEach { maxEventsCount ->
+                HtmlIterator().use { batchedIterator ->
+                    val callback = RefusingCallback()
+                    batchedIterator.setBatchedCallback(
+                        callback = callback,
+                        maxEventsCount = maxEventsCount,
+                    )
+                    batchedIterator.setContent(content = content)
+                    batchedIterator.iterate()
+
+                    assertEquals(
+                        actual = callback.steps == expectedCallback.steps,
+                        expected = true,
+                        message = {
+                            "Steps of $content differ for batch of $maxEventsCount events: " +
+                                    "${callback.steps}"
+                        },
+                    )
+                }
+            }
+        }
+    }
+
+
+    private fun checkSteps(
+        fileName: String,
+        iterate: (HtmlIterator) -> Unit,
+    ) {
+        val expectedCallback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = expectedCallback)
+        iterate(iterator)
+
+        Results.MAX_EVENTS_COUNTS.forEach { maxEventsCount ->
+            HtmlIterator().use { batchedIterator ->
+                val callback = StreamingInputTest.StreamingInputTestCallback()
+                batchedIterator.setBatchedCallback(
+                    callback = callback,
+                    maxEventsCount = maxEventsCount,
+                )
+                iterate(batchedIterator)
+
+                assertEquals(
+                    actual = callback.steps == expectedCallback.steps,
+                    expected = true,
+                    message = { "Steps of $fileName differ for batch of $maxEventsCount events" },
+                )
+            }
+        }
+    }
+}
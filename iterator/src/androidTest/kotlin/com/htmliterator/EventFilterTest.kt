@@ -0,0 +1,143 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that filter set by [HtmlIterator.setFilter] drops results natively, for callbacks set by
+ * both [HtmlIterator.setCallback] and [HtmlIterator.setBatchedCallback].
+ */
+@RunWith(AndroidJUnit4::class)
+class EventFilterTest : BaseAndroidTest() {
+
+
+    data object Results {
+        const val CONTENT: String = "<div><p>Hi <span>x</span> <a href=\"u\">link</a></p>" +
+                "<ul><li>skip</li></ul><img src=\"i\"><img><script>var a;</script></div>"
+
+        val FILTER: EventFilter = EventFilter(
+            tagNames = setOf("p", "A", "img"),
+            skippedTagNames = setOf("ul", "script"),
+        )
+
+        val FILTERED_STEPS: List<String> = listOf(
+            "pair p", "text Hi", "text x", "text  ", "pair a", "leaving a", "text link",
+            "leaving p", "single img", "single img",
+        )
+
+        val ATTRIBUTE_FILTER: EventFilter = FILTER.copy(
+            isTextReported = false,
+            requiredAttributes = setOf("SRC"),
+        )
+
+        val ATTRIBUTE_FILTERED_STEPS: List<String> = listOf("single img")
+    }
+
+
+    class EventFilterTestCallback : HtmlIterator.Callback() {
+        val steps: MutableList<String> = mutableListOf()
+
+        override fun onContentText(text: String) {
+            steps.add(element = "text $text")
+        }
+
+        override fun onSingleTag(tag: TagInfo) {
+            steps.add(element = "single ${tag.tag}")
+        }
+
+        override fun onPairTag(
+            tag: TagInfo,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ): Boolean {
+            super.onPairTag(
+                tag = tag,
+                openingTagStartIndex = openingTagStartIndex,
+                openingTagEndIndex = openingTagEndIndex,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            steps.add(element = "pair ${tag.tag}")
+            return true
+        }
+
+        override fun onLeavingPairTag(tag: TagInfo) {
+            super.onLeavingPairTag(tag = tag)
+            steps.add(element = "leaving ${tag.tag}")
+        }
+
+        override fun onScript(tag: TagInfo) {
+            steps.add(element = "script ${tag.tag}")
+        }
+    }
+
+
+    @Test
+    fun checkTagNamesAndSkippedTags() {
+        checkSteps(filter = Results.FILTER, expectedSteps = Results.FILTERED_STEPS)
+    }
+
+
+    @Test
+    fun checkRequiredAttributesWithoutText() {
+        checkSteps(
+            filter = Results.ATTRIBUTE_FILTER,
+            expectedSteps = Results.ATTRIBUTE_FILTERED_STEPS,
+        )
+    }
+
+
+    @Test
+    fun checkFilterRemoved() {
+        HtmlIterator().use { htmlIterator ->
+            val callback = EventFilterTestCallback()
+            htmlIterator.setFilter(filter = Results.FILTER)
+            htmlIterator.setFilter(filter = null)
+            htmlIterator.setCallback(callback = callback)
+            htmlIterator.setContent(content = Results.CONTENT)
+            htmlIterator.iterate()
+
+            assertEquals(
+                actual = callback.steps.contains(element = "pair div")
+                        && callback.steps.contains(element = "script script"),
+                expected = true,
+                message = { "Results are filtered after filter was removed: ${callback.steps}" },
+            )
+        }
+    }
+
+
+    private fun checkSteps(
+        filter: EventFilter,
+        expectedSteps: List<String>,
+    ) {
+        HtmlIterator().use { htmlIterator ->
+            val callback = EventFilterTestCallback()
+            htmlIterator.setFilter(filter = filter)
+            htmlIterator.setCallback(callback = callback)
+            htmlIterator.setContent(content = Results.CONTENT)
+            htmlIterator.iterate()
+
+            assertEquals(
+                actual = callback.steps == expectedSteps,
+                expected = true,
+                message = { "Steps differ: ${callback.steps}" },
+            )
+
+            val batchedCallback = EventFilterTestCallback()
+            htmlIterator.setBatchedCallback(callback = batchedCallback)
+            htmlIterator.setContent(content = Results.CONTENT)
+            htmlIterator.iterate()
+
+            assertEquals(
+                actual = batchedCallback.steps == expectedSteps,
+                expected = true,
+                message = { "Batched steps differ: ${batchedCallback.steps}" },
+            )
+        }
+    }
+}
@@ -7,7 +7,7 @@ import org.junit.runner.RunWith
 /**
  * Tests that verifies integration and availability of iterator library in kotlin. In this class all
  * cases which including calling java/kotlin methods directly from c++:
- * * Construction of TagInfo data class
+ * * Construction of TagInfo
  * * Settings [HtmlIterator.Callback] jobject reference in c++
  * * Calling [HtmlIterator.Callback] functions with results
  * Then the test is done by retrieved data and compare to expected [Results]
@@ -48,10 +48,10 @@ class KotlinIntegrationTest : BaseAndroidTest() {
 
         override fun onPairTag(
             tag: TagInfo,
-            openingTagStartIndex: Int,
-            openingTagEndIndex: Int,
-            closingTagStartIndex: Int,
-            closingTagEndIndex: Int,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
         ): Boolean {
             super.onPairTag(
                 tag=tag,
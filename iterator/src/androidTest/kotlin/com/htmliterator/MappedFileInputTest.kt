@@ -0,0 +1,83 @@
+package com.htmliterator
+
+import android.os.ParcelFileDescriptor
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+
+
+/**
+ * Checks that content of file set by [HtmlIterator.setContentFromFile] delivers the same steps as
+ * the same content set by [HtmlIterator.setContent] with [ByteArray].
+ */
+@RunWith(AndroidJUnit4::class)
+class MappedFileInputTest : BaseAndroidTest() {
+
+
+    @Test
+    fun checkMappedFullDocument() {
+        checkMappedContent(fileName = "full-doc-test1.html")
+    }
+
+
+    @Test
+    fun checkMappedPairTagMatching() {
+        checkMappedContent(fileName = "pair-tag-matching-test.html")
+    }
+
+
+    @Test
+    fun checkMissingFile() {
+        assertEquals(
+            actual = iterator.setContentFromFile(path = "/missing/file.html"),
+            expected = false,
+        )
+    }
+
+
+    private fun checkMappedContent(fileName: String) {
+        val content = loadAsset(fileName = fileName)
+        val file = File.createTempFile("mapped", ".html")
+        file.writeText(text = content)
+
+        try {
+            val expectedCallback = StreamingInputTest.StreamingInputTestCallback()
+            iterator.setCallback(callback = expectedCallback)
+            //String content is indexed by UTF-16 chars, so UTF-8 bytes are expected
+            iterator.setContent(bytes = content.toByteArray(charset = Charsets.UTF_8))
+            iterator.iterate()
+
+            val pathCallback = StreamingInputTest.StreamingInputTestCallback()
+            iterator.setCallback(callback = pathCallback)
+            assertEquals(
+                actual = iterator.setContentFromFile(path = file.absolutePath),
+                expected = true,
+            )
+            iterator.iterate()
+
+            val descriptorCallback = StreamingInputTest.StreamingInputTestCallback()
+            iterator.setCallback(callback = descriptorCallback)
+            ParcelFileDescriptor.open(file, ParcelFileDescriptor.MODE_READ_ONLY).use { descriptor ->
+                assertEquals(
+                    actual = iterator.setContentFromFileDescriptor(fd = descriptor.fd),
+                    expected = true,
+                )
+            }
+            iterator.iterate()
+
+            assertEquals(
+                actual = pathCallback.steps == expectedCallback.steps,
+                expected = true,
+                message = { "Steps differ for mapped $fileName" },
+            )
+            assertEquals(
+                actual = descriptorCallback.steps == expectedCallback.steps,
+                expected = true,
+                message = { "Steps differ for mapped descriptor of $fileName" },
+            )
+        } finally {
+            file.delete()
+        }
+    }
+}
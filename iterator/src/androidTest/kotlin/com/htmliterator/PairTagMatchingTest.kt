@@ -0,0 +1,129 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.After
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that pair tags are matched with their closing tags in both single pass mode and with
+ * [HtmlIterator.isClosingTagIndexEnabled]. Every pair tag has to be left, including unclosed ones.
+ */
+@RunWith(AndroidJUnit4::class)
+class PairTagMatchingTest : BaseAndroidTest() {
+
+
+    /**
+     * Results for pair-tag-matching-test.html file.
+     */
+    data object Results {
+        const val PAIR_TAGS_COUNT: Int = 8
+        const val UNCLOSED_PAIR_TAGS_COUNT: Int = 2
+    }
+
+
+    /**
+     * Collects closing tag indexes delivered in both [onPairTag] and [onLeavingPairTag].
+     */
+    class PairTagMatchingTestCallback : HtmlIterator.Callback() {
+        var pairTagsCount = 0
+        var pairTagsLeft = 0
+        val closingIndexesOnPairTag: MutableList<Long> = mutableListOf()
+        val closingIndexesOnLeaving: MutableList<Long> = mutableListOf()
+
+        override fun onPairTag(
+            tag: TagInfo,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ): Boolean {
+            super.onPairTag(
+                tag = tag,
+                openingTagStartIndex = openingTagStartIndex,
+                openingTagEndIndex = openingTagEndIndex,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            pairTagsCount += 1
+            closingIndexesOnPairTag.add(element = closingTagStartIndex)
+            return true
+        }
+
+        override fun onLeavingPairTag(
+            tag: TagInfo,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ) {
+            super.onLeavingPairTag(
+                tag = tag,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            pairTagsLeft += 1
+            closingIndexesOnLeaving.add(element = closingTagStartIndex)
+        }
+    }
+
+
+    @After
+    fun resetIterator() {
+        iterator.isClosingTagIndexEnabled = false
+    }
+
+
+    /**
+     * Without closing tag index, closing indexes are known only when leaving the tag.
+     */
+    @Test
+    fun checkSinglePassMatching() {
+        val content = loadAsset(fileName = "pair-tag-matching-test.html")
+        val callback = PairTagMatchingTestCallback()
+        iterator.isClosingTagIndexEnabled = false
+        iterator.setCallback(callback = callback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        assertEquals(actual = callback.pairTagsCount, expected = Results.PAIR_TAGS_COUNT)
+        assertEquals(actual = callback.pairTagsLeft, expected = Results.PAIR_TAGS_COUNT)
+        assertEquals(
+            actual = callback.closingIndexesOnPairTag.all { index -> index == -1L },
+            expected = true,
+        )
+        assertEquals(
+            actual = callback.closingIndexesOnLeaving.all { index ->
+                content.startsWith(prefix = "</", startIndex = index.toInt())
+            },
+            expected = true,
+        )
+    }
+
+
+    /**
+     * With closing tag index, closing indexes are known in [HtmlIterator.Callback.onPairTag] for
+     * all closed tags.
+     */
+    @Test
+    fun checkIndexedMatching() {
+        val content = loadAsset(fileName = "pair-tag-matching-test.html")
+        val callback = PairTagMatchingTestCallback()
+        iterator.isClosingTagIndexEnabled = true
+        iterator.setCallback(callback = callback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        assertEquals(actual = callback.pairTagsCount, expected = Results.PAIR_TAGS_COUNT)
+        assertEquals(actual = callback.pairTagsLeft, expected = Results.PAIR_TAGS_COUNT)
+        assertEquals(
+            actual = callback.closingIndexesOnPairTag.count { index -> index == -1L },
+            expected = Results.UNCLOSED_PAIR_TAGS_COUNT,
+        )
+        assertEquals(
+            actual = callback.closingIndexesOnPairTag
+                .filter { index -> index != -1L }
+                .all { index -> content.startsWith(prefix = "</", startIndex = index.toInt()) },
+            expected = true,
+        )
+    }
+}
@@ -0,0 +1,65 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+import kotlin.concurrent.thread
+
+
+/**
+ * Checks that separate [HtmlIterator] instances iterate on separate threads at once without
+ * affecting each other and that closed instance can't be used.
+ */
+@RunWith(AndroidJUnit4::class)
+class ParallelIteratorsTest : BaseAndroidTest() {
+
+
+    data object Results {
+        const val THREADS_COUNT: Int = 4
+        const val ITERATIONS_COUNT: Int = 20
+    }
+
+
+    @Test
+    fun checkParallelIterators() {
+        val content = loadAsset(fileName = "full-doc-test1.html")
+        val expectedCallback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = expectedCallback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        val results = Array(size = Results.THREADS_COUNT) { true }
+        val threads = List(size = Results.THREADS_COUNT) { index ->
+            thread {
+                HtmlIterator().use { threadIterator ->
+                    repeat(times = Results.ITERATIONS_COUNT) {
+                        val callback = StreamingInputTest.StreamingInputTestCallback()
+                        threadIterator.setCallback(callback = callback)
+                        threadIterator.setContent(content = content)
+                        threadIterator.iterate()
+                        if (callback.steps != expectedCallback.steps) {
+                            results[index] = false
+                        }
+                    }
+                }
+            }
+        }
+        threads.forEach(Thread::join)
+
+        results.forEachIndexed { index, isSame ->
+            assertEquals(
+                actual = isSame,
+                expected = true,
+                message = { "Steps differ on thread $index" },
+            )
+        }
+    }
+
+
+    @Test(expected = IllegalStateException::class)
+    fun checkClosedIterator() {
+        val closedIterator = HtmlIterator()
+        closedIterator.close()
+        closedIterator.setContent(content = "<p>text</p>")
+    }
+}
@@ -0,0 +1,99 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that content big enough to be lexed in parallel delivers the same steps as the same content
+ * streamed by [HtmlIterator.feed], which is never lexed in parallel.
+ */
+@RunWith(AndroidJUnit4::class)
+class ParallelTokenizationTest : BaseAndroidTest() {
+
+
+    data object Results {
+
+        /**
+         * Content is lexed in parallel from 1 MB, in UTF-8 bytes or UTF-16 chars.
+         */
+        const val MIN_CONTENT_LENGTH: Int = 1 shl 21
+        const val CHUNK_SIZE: Int = 8192
+    }
+
+
+    @Test
+    fun checkBigContent() {
+        val content = createBigContent()
+
+        val expectedCallback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = expectedCallback)
+        content.chunked(size = Results.CHUNK_SIZE).forEach { chunk ->
+            iterator.feed(chunk = chunk)
+        }
+        iterator.finish()
+
+        val callback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = callback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        assertEquals(
+            actual = callback.steps == expectedCallback.steps,
+            expected = true,
+            message = { "Steps of parallel lexed content differ" },
+        )
+    }
+
+
+    @Test
+    fun checkDisabledParallelTokenization() {
+        val content = createBigContent()
+        assertEquals(
+            actual = iterator.isParallelTokenizationEnabled,
+            expected = true,
+            message = { "Parallel tokenization is not enabled by default" },
+        )
+
+        val expectedCallback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = expectedCallback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        iterator.isParallelTokenizationEnabled = false
+        val callback = StreamingInputTest.StreamingInputTestCallback()
+        iterator.setCallback(callback = callback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+        iterator.isParallelTokenizationEnabled = true
+
+        assertEquals(
+            actual = callback.steps == expectedCallback.steps,
+            expected = true,
+            message = { "Steps differ when parallel tokenization is disabled" },
+        )
+    }
+
+
+    private fun createBigContent(): String {
+        //Different documents, so segment boundaries fall into different tags, comments and scripts
+        val documents = listOf(
+            "full-doc-test1.html",
+            "kotlin-integration-test.html",
+            "pair-tag-matching-test.html",
+            "tag-info-test.html",
+        ).map { fileName ->
+            loadAsset(fileName = fileName)
+                .substringAfter(delimiter = "<body>")
+                .substringBefore(delimiter = "</body>")
+        }
+        return buildString {
+            var i = 0
+            while (length < Results.MIN_CONTENT_LENGTH) {
+                append(documents[i % documents.size])
+                i += 1
+            }
+        }
+    }
+}
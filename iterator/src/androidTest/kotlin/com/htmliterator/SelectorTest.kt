@@ -0,0 +1,74 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that selectors set by [HtmlIterator.setSelectorCallback] are matched natively and only
+ * matching elements are delivered with their content ranges.
+ */
+@RunWith(AndroidJUnit4::class)
+class SelectorTest : BaseAndroidTest() {
+
+
+    data object Results {
+        const val CONTENT: String = "<div id=\"main\"><ul><li>1</li><li class=\"x\">2</li><li>3</li>" +
+                "</ul><p>t <a href=\"https://x.org\">l</a><img src=\"i\"></p></div>"
+
+        val SELECTORS: List<String> = listOf("li:nth-child(odd)", "div > p a", "#main img")
+
+        val MATCHES: List<String> = listOf("0 li 1", "0 li 3", "1 a l", "2 img -1")
+    }
+
+
+    @Test
+    fun checkMatches() {
+        HtmlIterator().use { htmlIterator ->
+            val matches = mutableListOf<String>()
+            htmlIterator.setSelectorCallback(
+                selectors = Results.SELECTORS,
+                callback = { tag, selectorIndex, contentStartIndex, contentEndIndex ->
+                    val content = if (contentStartIndex >= 0) {
+                        Results.CONTENT.substring(
+                            startIndex = contentStartIndex.toInt(),
+                            endIndex = contentEndIndex.toInt(),
+                        )
+                    } else contentStartIndex.toString()
+                    matches.add(element = "$selectorIndex ${tag.tag} $content")
+                },
+            )
+            htmlIterator.setContent(content = Results.CONTENT)
+            htmlIterator.iterate()
+
+            assertEquals(
+                actual = matches == Results.MATCHES,
+                expected = true,
+                message = { "Matches differ: $matches" },
+            )
+        }
+    }
+
+
+    @Test
+    fun checkInvalidSelector() {
+        HtmlIterator().use { htmlIterator ->
+            val isThrown = try {
+                htmlIterator.setSelectorCallback(
+                    selectors = listOf("li", "div >"),
+                    callback = { _, _, _, _ -> },
+                )
+                false
+            } catch (exception: IllegalArgumentException) {
+                true
+            }
+
+            assertEquals(
+                actual = isThrown,
+                expected = true,
+                message = { "Invalid selector was accepted" },
+            )
+        }
+    }
+}
@@ -0,0 +1,197 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that content streamed by [HtmlIterator.feed] in chunks of any size delivers the same steps
+ * as the whole content set by [HtmlIterator.setContent].
+ */
+@RunWith(AndroidJUnit4::class)
+class StreamingInputTest : BaseAndroidTest() {
+
+
+    /**
+     * Sizes of chunks, from chunks splitting every tag to chunk bigger than whole file.
+     */
+    data object Results {
+        val CHUNK_SIZES: List<Int> = listOf(1, 2, 7, 64, 16 * 1024)
+    }
+
+
+    /**
+     * Records every step as a line of text, so steps can be compared.
+     */
+    class StreamingInputTestCallback : HtmlIterator.Callback() {
+        val steps: MutableList<String> = mutableListOf()
+
+        override fun onContentText(text: String) {
+            steps.add(element = "text $text")
+        }
+
+        override fun onSingleTag(tag: TagInfo) {
+            steps.add(element = "single ${tag.tag} ${tag.attributes}")
+        }
+
+        override fun onPairTag(
+            tag: TagInfo,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ): Boolean {
+            super.onPairTag(
+                tag = tag,
+                openingTagStartIndex = openingTagStartIndex,
+                openingTagEndIndex = openingTagEndIndex,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            steps.add(element = "pair ${tag.tag} ${tag.attributes} $openingTagStartIndex")
+            return true
+        }
+
+        override fun onLeavingPairTag(
+            tag: TagInfo,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ) {
+            super.onLeavingPairTag(
+                tag = tag,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            steps.add(element = "leaving ${tag.tag} $closingTagStartIndex")
+        }
+
+        override fun onScript(tag: TagInfo) {
+            steps.add(element = "script ${tag.tag}")
+        }
+    }
+
+
+    @Test
+    fun checkStreamedKotlinIntegration() {
+        checkStreamedContent(fileName = "kotlin-integration-test.html")
+    }
+
+
+    @Test
+    fun checkStreamedFullDocument() {
+        checkStreamedContent(fileName = "full-doc-test1.html")
+    }
+
+
+    @Test
+    fun checkStreamedPairTagMatching() {
+        checkStreamedContent(fileName = "pair-tag-matching-test.html")
+    }
+
+
+    /**
+     * First chunk drops previous content which was iterated only partially, tags of the content are
+     * invalidated and streamed content gets the same steps as when it's set as a whole.
+     */
+    @Test
+    fun checkFeedAfterPartialIteration() {
+        val content = loadAsset(fileName = "kotlin-integration-test.html")
+        val expectedCallback = StreamingInputTestCallback()
+        iterator.setCallback(callback = expectedCallback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        var openedTag: TagInfo? = null
+        iterator.setCallback(callback = object : HtmlIterator.Callback() {
+            override fun onPairTag(
+                tag: TagInfo,
+                openingTagStartIndex: Long,
+                openingTagEndIndex: Long,
+                closingTagStartIndex: Long,
+                closingTagEndIndex: Long,
+            ): Boolean {
+                openedTag = openedTag ?: tag
+                return true
+            }
+        })
+        iterator.setContent(content = content)
+        repeat(times = 5) {
+            iterator.iterateSingleStep()
+        }
+
+        val callback = StreamingInputTestCallback()
+        iterator.setCallback(callback = callback)
+        content.chunked(size = Results.CHUNK_SIZES[2]).forEach { chunk ->
+            iterator.feed(chunk = chunk)
+        }
+        iterator.finish()
+
+        assertEquals(
+            actual = runCatching { openedTag?.body }.exceptionOrNull() is IllegalStateException,
+            expected = true,
+            message = { "Tag of previous content is not invalidated by new stream" },
+        )
+        assertEquals(
+            actual = callback.steps == expectedCallback.steps,
+            expected = true,
+            message = { "Steps of stream started after partial iteration differ" },
+        )
+    }
+
+
+    /**
+     * Batched callback starts new stream with state of decoder dropped, although previous content
+     * ended within refused tag.
+     */
+    @Test
+    fun checkBatchedFeedAfterPartialIteration() {
+        val content = "<div><ul><li>a</li></ul><p>after</p></div>"
+        val expectedCallback = EventBatchTest.RefusingCallback()
+        iterator.setCallback(callback = expectedCallback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        val callback = EventBatchTest.RefusingCallback()
+        iterator.setBatchedCallback(callback = callback, maxEventsCount = 1)
+        iterator.setContent(content = content)
+        repeat(times = 3) {
+            iterator.iterateSingleStep()
+        }
+        callback.steps.clear()
+        content.chunked(size = Results.CHUNK_SIZES[2]).forEach { chunk ->
+            iterator.feed(chunk = chunk)
+        }
+        iterator.finish()
+
+        assertEquals(
+            actual = callback.steps == expectedCallback.steps,
+            expected = true,
+            message = { "Steps of batched stream differ: ${callback.steps}" },
+        )
+    }
+
+
+    private fun checkStreamedContent(fileName: String) {
+        val content = loadAsset(fileName = fileName)
+        val expectedCallback = StreamingInputTestCallback()
+        iterator.setCallback(callback = expectedCallback)
+        iterator.setContent(content = content)
+        iterator.iterate()
+
+        Results.CHUNK_SIZES.forEach { chunkSize ->
+            val callback = StreamingInputTestCallback()
+            iterator.setCallback(callback = callback)
+            content.chunked(size = chunkSize).forEach { chunk ->
+                iterator.feed(chunk = chunk)
+            }
+            iterator.finish()
+
+            assertEquals(
+                actual = callback.steps == expectedCallback.steps,
+                expected = true,
+                message = { "Steps differ for $fileName in chunks of $chunkSize" },
+            )
+        }
+    }
+}
@@ -8,7 +8,7 @@ import kotlin.String
 
 
 /**
- * Test that verifies TagInfo data class including attributes and classes parsing from html content.
+ * Test that verifies TagInfo including attributes and classes parsing from html content.
  * All parsed attributes and classes should be without white chars and should be in lower case.
  * @author Miroslav Hýbler <br>
  * created on 11.12.2024
@@ -131,7 +131,7 @@ class TagInfoTest : BaseAndroidTest() {
         override fun onSingleTag(tag: TagInfo) {
             when (tag.tag) {
                 "img" -> {
-                    imgTagInfo = tag
+                    imgTagInfo = tag.detach()
                     imgResult = Results.img.compareByValues(tagInfo = tag)
                 }
 
@@ -141,34 +141,34 @@ class TagInfoTest : BaseAndroidTest() {
 
         override fun onPairTag(
             tag: TagInfo,
-            openingTagStartIndex: Int,
-            openingTagEndIndex: Int,
-            closingTagStartIndex: Int,
-            closingTagEndIndex: Int
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long
         ): Boolean {
             when (tag.tag) {
                 "div" -> when (tag.attributes["id"]) {
                     "main-content" -> {
-                        mainContentDivTagInfo = tag
+                        mainContentDivTagInfo = tag.detach()
                         mainContentDivResult = Results.mainContentDiv
                             .compareByValues(tagInfo = tag)
                     }
 
                     "header" -> {
-                        headerDivTagInfo = tag
+                        headerDivTagInfo = tag.detach()
                         headerDivResult = Results.headerDiv
                             .compareByValues(tagInfo = tag)
                     }
 
                     "content" -> {
-                        contentDivTagInfo = tag
+                        contentDivTagInfo = tag.detach()
                         contentDivResult = Results.contentDiv
                             .compareByValues(tagInfo = tag)
                     }
                 }
 
                 "a" -> {
-                    aTagInfo = tag
+                    aTagInfo = tag.detach()
                     aResult = Results.a.compareByValues(tagInfo = tag)
                 }
             }
@@ -246,6 +246,95 @@ class TagInfoTest : BaseAndroidTest() {
     }
 
 
+    /**
+     * Tag read after its callback returned keeps values read within the callback and its detached
+     * copy keeps all of them.
+     */
+    @Test
+    fun checkTagAfterCallback() {
+        var imgTagInfo: TagInfo? = null
+        var detachedImgTagInfo: TagInfo? = null
+        iterator.setContent(content = loadAsset(fileName = "tag-info-test.html"))
+        iterator.setCallback(callback = object : HtmlIterator.Callback() {
+            override fun onSingleTag(tag: TagInfo) {
+                if (tag.tag == "img") {
+                    imgTagInfo = tag
+                    detachedImgTagInfo = tag.detach()
+                }
+            }
+        })
+        iterator.iterate()
+
+        assertEquals(
+            actual = imgTagInfo?.tag == "img",
+            expected = true,
+            message = { "Tag name read within callback is not kept" },
+        )
+        assertEquals(
+            actual = runCatching { imgTagInfo?.body }.exceptionOrNull() is IllegalStateException,
+            expected = true,
+            message = { "Body not read within callback is available after callback" },
+        )
+        assertEquals(
+            actual = runCatching { imgTagInfo.toString() }.getOrNull()
+                ?.startsWith(prefix = "TagInfo(tag='img', attributes=<invalidated>") == true,
+            expected = true,
+            message = { "Tag after callback is not printed with invalidated values" },
+        )
+        assertEquals(
+            actual = runCatching { imgTagInfo == detachedImgTagInfo }.getOrNull() == false,
+            expected = true,
+            message = { "Tag after callback is not compared by identity" },
+        )
+        assertEquals(
+            actual = runCatching { imgTagInfo.hashCode() }.isSuccess,
+            expected = true,
+            message = { "Hash code of tag after callback is not available" },
+        )
+        assertEquals(
+            actual = detachedImgTagInfo?.let(block = Results.img::compareByValues) == true,
+            expected = true,
+            message = {
+                failMessage(
+                    label = "Detached img",
+                    expected = Results.img,
+                    given = detachedImgTagInfo,
+                )
+            }
+        )
+    }
+
+
+    /**
+     * Attribute repeated within the tag is kept only once with its first value, names are matched
+     * ignoring case, same as in browsers.
+     */
+    @Test
+    fun checkRepeatedAttributes() {
+        var attributes: Map<String, String> = emptyMap()
+        iterator.setContent(content = "<a HREF=\"first\" href=\"second\" title=\"t\">Link</a>")
+        iterator.setCallback(callback = object : HtmlIterator.Callback() {
+            override fun onPairTag(
+                tag: TagInfo,
+                openingTagStartIndex: Long,
+                openingTagEndIndex: Long,
+                closingTagStartIndex: Long,
+                closingTagEndIndex: Long,
+            ): Boolean {
+                attributes = tag.attributes
+                return true
+            }
+        })
+        iterator.iterate()
+
+        assertEquals(
+            actual = attributes == mapOf("HREF" to "first", "title" to "t"),
+            expected = true,
+            message = { "Repeated attribute is not dropped: $attributes" },
+        )
+    }
+
+
     private fun failMessage(
         label: String,
         expected: Results.TagResult,
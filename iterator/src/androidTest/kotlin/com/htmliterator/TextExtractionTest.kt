@@ -0,0 +1,74 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that [HtmlIterator.extractText] returns visible text of the content with breaks between
+ * block tags and without hidden content.
+ */
+@RunWith(AndroidJUnit4::class)
+class TextExtractionTest : BaseAndroidTest() {
+
+
+    data object Results {
+        const val CONTENT: String = "<html><head><title>T</title></head><body>\n<h1>Title</h1>\n" +
+                "<p>First   line<br>second</p><ul><li>a</li><li>b</li></ul><style>.x{}</style>" +
+                "<script>var a;</script><pre>\n  kept   spaces</pre></body></html>"
+
+        const val TEXT: String = "Title\n\nFirst line\nsecond\n\na\nb\n\n  kept   spaces"
+
+        const val PLAIN_CONTENT: String = "  Only plain   text "
+
+        const val PLAIN_TEXT: String = "Only plain text"
+
+        const val WHITE_CHARS_CONTENT: String = "<p>\r\nCarriage\r\n\r\n return\tand\u000Cform feed\r\n</p>"
+
+        const val WHITE_CHARS_TEXT: String = "Carriage return and form feed"
+    }
+
+
+    @Test
+    fun checkExtractedText() {
+        iterator.setContent(content = Results.CONTENT)
+        val text = iterator.extractText()
+
+        assertEquals(
+            actual = text == Results.TEXT,
+            expected = true,
+            message = { "Extracted text differs: $text" },
+        )
+    }
+
+
+    @Test
+    fun checkPlainContent() {
+        iterator.setContent(content = Results.PLAIN_CONTENT)
+        val text = iterator.extractText()
+
+        assertEquals(
+            actual = text == Results.PLAIN_TEXT,
+            expected = true,
+            message = { "Extracted text differs: $text" },
+        )
+    }
+
+
+    /**
+     * Carriage return and form feed are white chars of html, so they are collapsed the same way as
+     * space, tab and line feed.
+     */
+    @Test
+    fun checkWhiteChars() {
+        iterator.setContent(content = Results.WHITE_CHARS_CONTENT)
+        val text = iterator.extractText()
+
+        assertEquals(
+            actual = text == Results.WHITE_CHARS_TEXT,
+            expected = true,
+            message = { "Extracted text differs: $text" },
+        )
+    }
+}
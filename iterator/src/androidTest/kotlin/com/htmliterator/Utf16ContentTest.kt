@@ -0,0 +1,74 @@
+package com.htmliterator
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Test
+import org.junit.runner.RunWith
+
+
+/**
+ * Checks that [String] content is iterated as UTF-16, so texts are delivered unchanged and indexes
+ * are char indexes within the content.
+ */
+@RunWith(AndroidJUnit4::class)
+class Utf16ContentTest : BaseAndroidTest() {
+
+
+    /**
+     * Content with accented chars, surrogate pair and U+013C which has '<' as its low byte.
+     */
+    data object Results {
+        const val CONTENT: String = "<div><p>Příliš žluťoučký kůň 🐎</p><span>ļ</span></div>"
+        val TEXTS: List<String> = listOf("Příliš žluťoučký kůň 🐎", "ļ")
+    }
+
+
+    /**
+     * Collects texts and opening tag indexes.
+     */
+    class Utf16ContentTestCallback : HtmlIterator.Callback() {
+        val texts: MutableList<String> = mutableListOf()
+        val openingIndexes: MutableMap<String, Long> = mutableMapOf()
+
+        override fun onContentText(text: String) {
+            super.onContentText(text = text)
+            texts.add(element = text)
+        }
+
+        override fun onPairTag(
+            tag: TagInfo,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ): Boolean {
+            super.onPairTag(
+                tag = tag,
+                openingTagStartIndex = openingTagStartIndex,
+                openingTagEndIndex = openingTagEndIndex,
+                closingTagStartIndex = closingTagStartIndex,
+                closingTagEndIndex = closingTagEndIndex,
+            )
+            openingIndexes[tag.tag] = openingTagStartIndex
+            return true
+        }
+    }
+
+
+    @Test
+    fun checkTextsAndIndexes() {
+        val callback = Utf16ContentTestCallback()
+        iterator.setCallback(callback = callback)
+        iterator.setContent(content = Results.CONTENT)
+        iterator.iterate()
+
+        assertEquals(
+            actual = callback.texts == Results.TEXTS,
+            expected = true,
+            message = { "Texts differ: ${callback.texts}" },
+        )
+        assertEquals(
+            actual = callback.openingIndexes["span"]?.toInt() ?: -1,
+            expected = Results.CONTENT.indexOf(string = "<span>"),
+        )
+    }
+}
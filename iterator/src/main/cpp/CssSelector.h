@@ -0,0 +1,639 @@
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HtmlNames.h"
+#include "StringUtils.h"
+#include "TagInfo.h"
+
+#ifndef ANDROID_HTML_ITERATOR_CSSSELECTOR_H
+#define ANDROID_HTML_ITERATOR_CSSSELECTOR_H
+
+
+/**
+ * Compiled CSS selector, matched against element and its ancestors without any DOM. Supported are
+ * type selectors, universal selector '*', classes, ids, attribute selectors ([a], [a=v], [a~=v],
+ * [a|=v], [a^=v], [a$=v], [a*=v]), <code>:nth-child()</code> with an+b, odd or even, descendant and
+ * child combinators and lists of selectors separated by ','. Tag and attribute names are matched
+ * ignoring case, classes, ids and attribute values are matched exactly.
+ * <br>
+ * Compound selectors are kept from right to left, so element is matched first and its ancestors are
+ * visited only when the element matches, same as browsers do.
+ * <br>
+ * CharT is type of code units of the content, selector is parsed from text of the same type, so
+ * values are compared without any conversion.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class BasicCssSelector {
+
+public:
+    using String = std::basic_string<CharT>;
+    using StringView = std::basic_string_view<CharT>;
+    using TagInfo = BasicTagInfo<CharT>;
+
+
+    /**
+     * Element being matched, see <code>matches</code>.
+     * @since 1.0.0
+     */
+    struct Element {
+        const TagInfo *tag;
+
+        /**
+         * Position of the element among its siblings, starting with 1, see :nth-child.
+         */
+        uint32_t position;
+
+        /**
+         * Count of child elements seen so far, position of the next child is one bigger.
+         */
+        uint32_t childrenCount;
+    };
+
+
+private:
+
+    enum class Combinator : uint8_t {
+        NONE,
+        DESCENDANT,
+        CHILD,
+    };
+
+
+    enum class AttributeOperator : uint8_t {
+        EXISTS,
+        EQUALS,
+        INCLUDES,
+        DASH_MATCH,
+        PREFIX,
+        SUFFIX,
+        SUBSTRING,
+    };
+
+
+    struct AttributeCondition {
+        String name;
+        AttributeOperator op;
+        String value;
+    };
+
+
+    /**
+     * Compound selector, conditions of single element.
+     */
+    struct Compound {
+        String tag;
+        htmlNames::TagId tagId = htmlNames::TagId::UNKNOWN;
+        bool isAnyTag = true;
+        std::vector<String> ids;
+        std::vector<String> classes;
+        std::vector<AttributeCondition> attributes;
+        bool hasNthChild = false;
+        int32_t nthA = 0;
+        int32_t nthB = 0;
+
+        /**
+         * Combinator between this compound and the next one to the left.
+         */
+        Combinator combinator = Combinator::NONE;
+    };
+
+
+    /**
+     * Selectors of the list, every one of them is list of compounds from right to left.
+     */
+    std::vector<std::vector<Compound>> alternatives;
+
+
+public:
+
+    /**
+     * Compiles the selector, previously compiled selector is dropped.
+     * @param text Selector or list of selectors separated by ','.
+     * @return True when selector was compiled, false when text is not valid selector.
+     * @since 1.0.0
+     */
+    bool parse(StringView text) {
+        alternatives.clear();
+        size_t i = 0;
+        while (true) {
+            std::vector<Compound> compounds;
+            if (!parseComplex(text, i, compounds)) {
+                alternatives.clear();
+                return false;
+            }
+            alternatives.push_back(std::move(compounds));
+            if (i >= text.length()) {
+                return true;
+            }
+            //parseComplex stops only at the end or at ','
+            i += 1;
+        }
+    }
+
+
+    /**
+     * @param elements Element being matched as the last one, preceded by all of its ancestors.
+     * @return True when the last element matches any selector of the list.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool matches(const std::vector<Element> &elements) const {
+        if (elements.empty()) {
+            return false;
+        }
+        for (const std::vector<Compound> &compounds: alternatives) {
+            if (matches(compounds, 0, elements, elements.size() - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+private:
+
+    [[nodiscard]] static bool matches(
+            const std::vector<Compound> &compounds,
+            size_t compoundIndex,
+            const std::vector<Element> &elements,
+            size_t elementIndex
+    ) {
+        const Compound &compound = compounds[compoundIndex];
+        if (!matches(compound, elements[elementIndex])) {
+            return false;
+        }
+        if (compoundIndex + 1 == compounds.size()) {
+            return true;
+        }
+        if (compound.combinator == Combinator::CHILD) {
+            return elementIndex > 0 && matches(compounds, compoundIndex + 1, elements, elementIndex - 1);
+        }
+        //Descendant, any of ancestors may match the rest
+        for (size_t i = elementIndex; i > 0; i--) {
+            if (matches(compounds, compoundIndex + 1, elements, i - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    [[nodiscard]] static bool matches(
+            const Compound &compound,
+            const Element &element
+    ) {
+        const TagInfo &tag = *element.tag;
+        if (!compound.isAnyTag) {
+            if (compound.tagId != tag.getTagId()) {
+                return false;
+            }
+            if (compound.tagId == htmlNames::TagId::UNKNOWN
+                && !htmlNames::equalsIgnoreCase(StringView(compound.tag), tag.getTag())) {
+                return false;
+            }
+        }
+        if (compound.hasNthChild && !isNthChild(compound.nthA, compound.nthB, element.position)) {
+            return false;
+        }
+        static constexpr CharT idAttributeName[] = {'i', 'd'};
+        for (const String &id: compound.ids) {
+            StringView value;
+            if (!findAttribute(tag, StringView(idAttributeName, 2), value) || value != id) {
+                return false;
+            }
+        }
+        if (!compound.classes.empty()) {
+            const auto &classes = tag.getClasses();
+            for (const String &clazz: compound.classes) {
+                bool hasClass = false;
+                for (const StringView &tagClass: classes) {
+                    if (tagClass == clazz) {
+                        hasClass = true;
+                        break;
+                    }
+                }
+                if (!hasClass) {
+                    return false;
+                }
+            }
+        }
+        for (const AttributeCondition &condition: compound.attributes) {
+            StringView value;
+            if (!findAttribute(tag, condition.name, value)
+                || !matches(condition.op, value, condition.value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    [[nodiscard]] static bool matches(
+            AttributeOperator op,
+            StringView value,
+            StringView expected
+    ) {
+        switch (op) {
+            case AttributeOperator::EXISTS:
+                return true;
+            case AttributeOperator::EQUALS:
+                return value == expected;
+            case AttributeOperator::INCLUDES: {
+                if (expected.empty()) {
+                    return false;
+                }
+                size_t i = 0;
+                while (i < value.length()) {
+                    size_t s = stringUtils::nextNonWhiteChar(value, i, value.length());
+                    if (s == std::string::npos) {
+                        return false;
+                    }
+                    size_t e = stringUtils::nextWhiteChar(value, s, value.length());
+                    if (e == std::string::npos) {
+                        e = value.length();
+                    }
+                    if (value.substr(s, e - s) == expected) {
+                        return true;
+                    }
+                    i = e;
+                }
+                return false;
+            }
+            case AttributeOperator::DASH_MATCH:
+                return value == expected
+                       || (value.length() > expected.length()
+                           && value.substr(0, expected.length()) == expected
+                           && value[expected.length()] == '-');
+            case AttributeOperator::PREFIX:
+                return !expected.empty() && value.substr(0, expected.length()) == expected;
+            case AttributeOperator::SUFFIX:
+                return !expected.empty() && value.length() >= expected.length()
+                       && value.substr(value.length() - expected.length()) == expected;
+            case AttributeOperator::SUBSTRING:
+                return !expected.empty() && value.find(expected) != StringView::npos;
+        }
+        return false;
+    }
+
+
+    /**
+     * Finds attribute by name ignoring case.
+     * @return True when tag has the attribute, its value is written into outValue.
+     * @since 1.0.0
+     */
+    [[nodiscard]] static bool findAttribute(
+            const TagInfo &tag,
+            StringView name,
+            StringView &outValue
+    ) {
+        const auto &attributes = tag.getOutMap();
+        if (!attributes.contains(name)) {
+            return false;
+        }
+        outValue = attributes.find(name);
+        return true;
+    }
+
+
+    /**
+     * @return True when position is a*n + b for some n >= 0.
+     * @since 1.0.0
+     */
+    [[nodiscard]] static bool isNthChild(int32_t a, int32_t b, uint32_t position) {
+        int64_t difference = static_cast<int64_t>(position) - b;
+        if (a == 0) {
+            return difference == 0;
+        }
+        return difference % a == 0 && difference / a >= 0;
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    /////
+    /////   Parsing
+    /////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+    /**
+     * Parses single selector of the list from i until the end of the text or ','.
+     * @param compounds Compounds of the selector, from right to left.
+     * @since 1.0.0
+     */
+    static bool parseComplex(
+            StringView text,
+            size_t &i,
+            std::vector<Compound> &compounds
+    ) {
+        skipWhiteChars(text, i);
+        while (true) {
+            Compound compound;
+            if (!parseCompound(text, i, compound)) {
+                return false;
+            }
+            compounds.push_back(std::move(compound));
+
+            bool hasWhiteChars = skipWhiteChars(text, i);
+            if (i >= text.length() || text[i] == ',') {
+                break;
+            }
+            Combinator combinator = Combinator::DESCENDANT;
+            if (text[i] == '>') {
+                combinator = Combinator::CHILD;
+                i += 1;
+                skipWhiteChars(text, i);
+            } else if (!hasWhiteChars) {
+                return false;
+            }
+            compounds.back().combinator = combinator;
+        }
+
+        //Compounds are matched from right to left, combinator moves to the compound on its right
+        std::vector<Compound> reversed;
+        for (size_t j = compounds.size(); j > 0; j--) {
+            reversed.push_back(std::move(compounds[j - 1]));
+            reversed.back().combinator = j > 1 ? compounds[j - 2].combinator : Combinator::NONE;
+        }
+        compounds.swap(reversed);
+        return true;
+    }
+
+
+    static bool parseCompound(
+            StringView text,
+            size_t &i,
+            Compound &compound
+    ) {
+        size_t start = i;
+        if (i < text.length() && text[i] == '*') {
+            i += 1;
+        } else if (i < text.length() && isNameChar(text[i])) {
+            compound.tag = String(parseName(text, i));
+            compound.tagId = htmlNames::getTagId(StringView(compound.tag));
+            compound.isAnyTag = false;
+        }
+
+        while (i < text.length()) {
+            CharT ch = text[i];
+            if (ch == '#' || ch == '.') {
+                i += 1;
+                StringView name = parseName(text, i);
+                if (name.empty()) {
+                    return false;
+                }
+                (ch == '#' ? compound.ids : compound.classes).emplace_back(name);
+            } else if (ch == '[') {
+                i += 1;
+                AttributeCondition condition;
+                if (!parseAttribute(text, i, condition)) {
+                    return false;
+                }
+                compound.attributes.push_back(std::move(condition));
+            } else if (ch == ':') {
+                i += 1;
+                if (!parseNthChild(text, i, compound)) {
+                    return false;
+                }
+            } else {
+                break;
+            }
+        }
+        //Empty compound is not valid, e.g. "div > > p"
+        return i > start;
+    }
+
+
+    /**
+     * Parses attribute selector after '[' including closing ']'.
+     * @since 1.0.0
+     */
+    static bool parseAttribute(
+            StringView text,
+            size_t &i,
+            AttributeCondition &condition
+    ) {
+        skipWhiteChars(text, i);
+        StringView name = parseName(text, i);
+        if (name.empty()) {
+            return false;
+        }
+        condition.name = String(name);
+        condition.op = AttributeOperator::EXISTS;
+        skipWhiteChars(text, i);
+        if (i >= text.length()) {
+            return false;
+        }
+        if (text[i] == ']') {
+            i += 1;
+            return true;
+        }
+
+        if (text[i] != '=') {
+            switch (text[i]) {
+                case '~':
+                    condition.op = AttributeOperator::INCLUDES;
+                    break;
+                case '|':
+                    condition.op = AttributeOperator::DASH_MATCH;
+                    break;
+                case '^':
+                    condition.op = AttributeOperator::PREFIX;
+                    break;
+                case '$':
+                    condition.op = AttributeOperator::SUFFIX;
+                    break;
+                case '*':
+                    condition.op = AttributeOperator::SUBSTRING;
+                    break;
+                default:
+                    return false;
+            }
+            i += 1;
+            if (i >= text.length() || text[i] != '=') {
+                return false;
+            }
+        } else {
+            condition.op = AttributeOperator::EQUALS;
+        }
+        i += 1;
+        skipWhiteChars(text, i);
+        if (i >= text.length()) {
+            return false;
+        }
+
+        if (text[i] == '"' || text[i] == '\'') {
+            CharT quote = text[i];
+            size_t valueEnd = text.find(quote, i + 1);
+            if (valueEnd == StringView::npos) {
+                return false;
+            }
+            condition.value = String(text.substr(i + 1, valueEnd - i - 1));
+            i = valueEnd + 1;
+        } else {
+            StringView value = parseName(text, i);
+            if (value.empty()) {
+                return false;
+            }
+            condition.value = String(value);
+        }
+        skipWhiteChars(text, i);
+        if (i >= text.length() || text[i] != ']') {
+            return false;
+        }
+        i += 1;
+        return true;
+    }
+
+
+    /**
+     * Parses pseudo class after ':', only <code>nth-child(an+b)</code> is supported.
+     * @since 1.0.0
+     */
+    static bool parseNthChild(
+            StringView text,
+            size_t &i,
+            Compound &compound
+    ) {
+        StringView name = parseName(text, i);
+        if (!htmlNames::equalsIgnoreCase(name, std::string_view("nth-child"))
+            || i >= text.length() || text[i] != '(') {
+            return false;
+        }
+        size_t argumentEnd = text.find(')', i);
+        if (argumentEnd == StringView::npos) {
+            return false;
+        }
+        StringView argument = text.substr(i + 1, argumentEnd - i - 1);
+        i = argumentEnd + 1;
+        stringUtils::trim(argument);
+        compound.hasNthChild = true;
+
+        if (htmlNames::equalsIgnoreCase(argument, std::string_view("odd"))) {
+            compound.nthA = 2;
+            compound.nthB = 1;
+            return true;
+        }
+        if (htmlNames::equalsIgnoreCase(argument, std::string_view("even"))) {
+            compound.nthA = 2;
+            compound.nthB = 0;
+            return true;
+        }
+
+        //an+b, white chars are allowed around the sign of b
+        size_t nIndex = StringView::npos;
+        for (size_t k = 0; k < argument.length(); k++) {
+            if (argument[k] == 'n' || argument[k] == 'N') {
+                nIndex = k;
+                break;
+            }
+        }
+        if (nIndex != StringView::npos) {
+            StringView a = argument.substr(0, nIndex);
+            if (a.empty() || a == StringView(plusSign, 1)) {
+                compound.nthA = 1;
+            } else if (a == StringView(minusSign, 1)) {
+                compound.nthA = -1;
+            } else if (!parseInteger(a, compound.nthA)) {
+                return false;
+            }
+            size_t bStart = nIndex + 1;
+            skipWhiteChars(argument, bStart);
+            if (bStart >= argument.length()) {
+                compound.nthB = 0;
+                return true;
+            }
+            CharT sign = argument[bStart];
+            if (sign != '+' && sign != '-') {
+                return false;
+            }
+            bStart += 1;
+            skipWhiteChars(argument, bStart);
+            StringView b = argument.substr(bStart);
+            if (b.empty() || b[0] == '+' || b[0] == '-' || !parseInteger(b, compound.nthB)) {
+                return false;
+            }
+            if (sign == '-') {
+                compound.nthB = -compound.nthB;
+            }
+            return true;
+        }
+        compound.nthA = 0;
+        return parseInteger(argument, compound.nthB);
+    }
+
+
+    /**
+     * Parses optionally signed decimal integer, whole text has to be the number.
+     * @since 1.0.0
+     */
+    static bool parseInteger(StringView text, int32_t &outValue) {
+        size_t i = 0;
+        bool isNegative = false;
+        if (i < text.length() && (text[i] == '+' || text[i] == '-')) {
+            isNegative = text[i] == '-';
+            i += 1;
+        }
+        if (i >= text.length()) {
+            return false;
+        }
+        int64_t value = 0;
+        for (; i < text.length(); i++) {
+            if (text[i] < '0' || text[i] > '9') {
+                return false;
+            }
+            value = value * 10 + (text[i] - '0');
+            if (value > INT32_MAX) {
+                return false;
+            }
+        }
+        outValue = static_cast<int32_t>(isNegative ? -value : value);
+        return true;
+    }
+
+
+    /**
+     * @return Name starting at i, i is moved behind it. Empty when there is no name at i.
+     * @since 1.0.0
+     */
+    static StringView parseName(StringView text, size_t &i) {
+        size_t start = i;
+        while (i < text.length() && isNameChar(text[i])) {
+            i += 1;
+        }
+        return text.substr(start, i - start);
+    }
+
+
+    /**
+     * @return True when ch can be part of name, escapes are not supported.
+     * @since 1.0.0
+     */
+    static bool isNameChar(CharT ch) {
+        auto unit = static_cast<std::make_unsigned_t<CharT>>(ch);
+        return (unit >= 'a' && unit <= 'z') || (unit >= 'A' && unit <= 'Z')
+               || (unit >= '0' && unit <= '9') || unit == '-' || unit == '_' || unit >= 0x80;
+    }
+
+
+    /**
+     * @return True when any white char was skipped.
+     * @since 1.0.0
+     */
+    static bool skipWhiteChars(StringView text, size_t &i) {
+        size_t start = i;
+        while (i < text.length() && stringUtils::isWhiteChar(text[i])) {
+            i += 1;
+        }
+        return i > start;
+    }
+
+
+    static constexpr CharT plusSign[] = {'+'};
+    static constexpr CharT minusSign[] = {'-'};
+};
+
+
+using CssSelector = BasicCssSelector<char>;
+
+#endif //ANDROID_HTML_ITERATOR_CSSSELECTOR_H
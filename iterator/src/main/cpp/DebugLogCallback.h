@@ -29,7 +29,7 @@ public:
     void onSingleTag(TagInfo &tag) override {
         platformUtils::log(
                 "HtmlIterator",
-                "DebugLogCallback -- onSingleTag() -- tag: " + tag.getTag()
+                "DebugLogCallback -- onSingleTag() -- tag: " + std::string(tag.getTag())
         );
     }
 
@@ -37,31 +37,35 @@ public:
     void onScript(TagInfo &tag) override {
         platformUtils::log(
                 "HtmlIterator",
-                "DebugLogCallback -- onScript() -- tag: " + tag.getTag()
+                "DebugLogCallback -- onScript() -- tag: " + std::string(tag.getTag())
         );
     }
 
 
     bool onPairTag(
             TagInfo &tag,
-            size_t openingTagStartIndex,
-            size_t openingTagEndIndex,
-            size_t closingTagStartIndex,
-            size_t closingTagEndIndex
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
     ) override {
         platformUtils::log(
                 "HtmlIterator",
-                "DebugLogCallback -- onPairTag() -- tag: " + tag.getTag()
+                "DebugLogCallback -- onPairTag() -- tag: " + std::string(tag.getTag())
         );
 
         return true;
     };
 
 
-    void onLeavingPairTag(TagInfo &tag) override {
+    void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
         platformUtils::log(
                 "HtmlIterator",
-                "DebugLogCallback -- onLeavingPairTag() -- tag: " + tag.getTag()
+                "DebugLogCallback -- onLeavingPairTag() -- tag: " + std::string(tag.getTag())
         );
     }
 };
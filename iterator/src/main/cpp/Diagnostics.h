@@ -0,0 +1,150 @@
+#include <array>
+#include <string>
+#include <string_view>
+#include "PlatformUtils.h"
+
+#ifndef ANDROID_HTML_ITERATOR_DIAGNOSTICS_H
+#define ANDROID_HTML_ITERATOR_DIAGNOSTICS_H
+
+
+/**
+ * Kind of recoverable problem found in html content. Html content can have syntax errors and
+ * iterator keeps going like browsers do, problems are only reported.
+ * @since 1.0.0
+ */
+enum class DiagnosticCode : uint8_t {
+
+    /**
+     * Tag was opened by '<' but there is no '>' closing it.
+     */
+    UNTERMINATED_TAG,
+
+    /**
+     * Raw text element like &lt;head&gt; or &lt;script&gt; has no closing tag.
+     */
+    UNCLOSED_RAW_TEXT_TAG,
+
+    /**
+     * Pair tag has no closing tag, it's closed by closing tag of its parent or at the end of the
+     * content.
+     */
+    UNCLOSED_PAIR_TAG,
+
+    /**
+     * Closing tag without opened tag of the same name, it's ignored.
+     */
+    UNEXPECTED_CLOSING_TAG,
+};
+
+
+/**
+ * Single reported problem. Holds no copy of the content, tagName is a view into content of
+ * HtmlIterator and it's valid only while the content is set. For streamed content it's valid only
+ * until the next chunk.
+ * @since 1.0.0
+ */
+template<typename CharT>
+struct BasicDiagnostic {
+    DiagnosticCode code;
+
+    /**
+     * Index of '<' char of the tag causing the problem within the whole input.
+     */
+    uint64_t index;
+
+    std::basic_string_view<CharT> tagName;
+};
+
+
+/**
+ * Bounded ring buffer of diagnostics. Reporting never allocates, when buffer is full the oldest
+ * diagnostic is overwritten, so malformed content with thousands of errors costs the same memory
+ * as valid one.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class BasicDiagnostics {
+
+public:
+    static constexpr size_t capacity = 32;
+
+
+private:
+    std::array<BasicDiagnostic<CharT>, capacity> entries{};
+
+    /**
+     * Count of all reported diagnostics since the last clear, including overwritten ones.
+     */
+    size_t totalCount = 0;
+
+
+public:
+
+
+    /**
+     * Reports new diagnostic, in logging builds it's also logged.
+     * @param code Kind of the problem.
+     * @param index Index of '<' char of the tag causing the problem.
+     * @param tagName Name of the tag causing the problem, may be empty.
+     * @since 1.0.0
+     */
+    void report(
+            DiagnosticCode code,
+            uint64_t index,
+            const std::basic_string_view<CharT> &tagName
+    ) {
+        entries[totalCount % capacity] = {code, index, tagName};
+        totalCount += 1;
+
+        if (isLoggingEnabled) {
+            platformUtils::log(
+                    "HtmlIterator",
+                    "Diagnostic " + std::to_string(static_cast<int>(code))
+                    + " at index " + std::to_string(index)
+                    + " for tag: " + std::string(tagName.begin(), tagName.end()),
+                    ANDROID_LOG_WARN
+            );
+        }
+    }
+
+
+    /**
+     * @return Count of diagnostics held in buffer, at most <code>capacity</code>.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t size() const {
+        return totalCount < capacity ? totalCount : capacity;
+    }
+
+
+    /**
+     * @return Count of all reported diagnostics since the last clear, including ones overwritten
+     * in buffer.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t getTotalCount() const {
+        return totalCount;
+    }
+
+
+    /**
+     * @param i Index of diagnostic, 0 is the oldest held one. Must be less than <code>size()</code>.
+     * @return Diagnostic at i.
+     * @since 1.0.0
+     */
+    [[nodiscard]] const BasicDiagnostic<CharT> &get(size_t i) const {
+        size_t oldest = totalCount < capacity ? 0 : totalCount % capacity;
+        return entries[(oldest + i) % capacity];
+    }
+
+
+    void clear() {
+        totalCount = 0;
+    }
+};
+
+
+using Diagnostic = BasicDiagnostic<char>;
+using Diagnostics = BasicDiagnostics<char>;
+
+#endif //ANDROID_HTML_ITERATOR_DIAGNOSTICS_H
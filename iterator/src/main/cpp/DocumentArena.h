@@ -0,0 +1,226 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#ifndef ANDROID_HTML_ITERATOR_DOCUMENTARENA_H
+#define ANDROID_HTML_ITERATOR_DOCUMENTARENA_H
+
+
+/**
+ * Bump allocator backing containers of single document iterated by HtmlIterator. Memory is
+ * taken from blocks which are never freed while the document is iterated, deallocation does
+ * nothing. <code>reset</code> makes all blocks available again, blocks up to
+ * <code>MAX_RETAINED_CAPACITY</code> are kept, so iterating many small documents one by one stops
+ * touching malloc once blocks are big enough, while single big document doesn't keep its memory.
+ * <br>
+ * Containers using the arena must not hold any memory when arena is reset, even empty containers
+ * may hold some, so they are reset together with the arena by <code>resetWith</code>.
+ * <br>
+ * Arena can be bypassed for content which has no end known in advance, e.g. streamed content,
+ * where released memory has to be returned right away, see <code>setBypassed</code>.
+ * @since 1.0.0
+ */
+class DocumentArena : public std::pmr::memory_resource {
+
+private:
+
+    struct Block {
+        std::byte *data;
+        size_t size;
+    };
+
+
+    /**
+     * Size of the first block, blocks are doubling for bigger documents.
+     * @since 1.0.0
+     */
+    static constexpr size_t INITIAL_BLOCK_SIZE = 16 * 1024;
+
+
+    /**
+     * Maximal count of bytes in blocks kept by <code>reset</code>, bigger blocks are freed.
+     * @since 1.0.0
+     */
+    static constexpr size_t MAX_RETAINED_CAPACITY = 1024 * 1024;
+
+
+    std::pmr::memory_resource *upstream = std::pmr::new_delete_resource();
+    std::vector<Block> blocks;
+
+
+    /**
+     * Index into <code>blocks</code> of the block memory is taken from.
+     * @since 1.0.0
+     */
+    size_t blockIndex = 0;
+
+
+    /**
+     * Used bytes of the current block.
+     * @since 1.0.0
+     */
+    size_t blockOffset = 0;
+
+
+    /**
+     * True when memory is taken from upstream resource and deallocated right away.
+     * @since 1.0.0
+     */
+    bool isBypassed = false;
+
+
+public:
+    DocumentArena() = default;
+
+    DocumentArena(const DocumentArena &) = delete;
+
+    DocumentArena &operator=(const DocumentArena &) = delete;
+
+
+    ~DocumentArena() override {
+        for (const Block &block: blocks) {
+            upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+        }
+    }
+
+
+    /**
+     * Makes all memory available for the next document, capacity up to
+     * <code>MAX_RETAINED_CAPACITY</code> is kept. Arena is no longer bypassed.
+     * @since 1.0.0
+     */
+    void reset() {
+        //Blocks are doubling, so the last blocks are the biggest ones
+        size_t capacity = getCapacity();
+        while (capacity > MAX_RETAINED_CAPACITY) {
+            const Block &block = blocks.back();
+            capacity -= block.size;
+            upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+            blocks.pop_back();
+        }
+        blockIndex = 0;
+        blockOffset = 0;
+        isBypassed = false;
+    }
+
+
+    /**
+     * Destroys containers, resets the arena and constructs the containers again, empty and using
+     * the arena.
+     * @param containers Containers using the arena, constructible from memory resource.
+     * @since 1.0.0
+     */
+    template<typename... Containers>
+    void resetWith(Containers &... containers) {
+        (std::destroy_at(&containers), ...);
+        reset();
+        (new(&containers) Containers(static_cast<std::pmr::memory_resource *>(this)), ...);
+    }
+
+
+    /**
+     * @param bypassed True to take memory from upstream resource until <code>reset</code>, so memory
+     * released by containers is returned right away. Must be set before anything is allocated for
+     * the document.
+     * @since 1.0.0
+     */
+    void setBypassed(bool bypassed) {
+        this->isBypassed = bypassed;
+    }
+
+
+    /**
+     * @return Count of bytes in all blocks.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t getCapacity() const {
+        size_t capacity = 0;
+        for (const Block &block: blocks) {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+
+
+protected:
+
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        if (isBypassed) {
+            return upstream->allocate(bytes, alignment);
+        }
+        while (blockIndex < blocks.size()) {
+            void *memory = allocateFromBlock(blocks[blockIndex], bytes, alignment);
+            if (memory != nullptr) {
+                return memory;
+            }
+            //Rest of the block is wasted until reset, next blocks are bigger
+            blockIndex += 1;
+            blockOffset = 0;
+        }
+
+        size_t blockSize = blocks.empty() ? INITIAL_BLOCK_SIZE : blocks.back().size * 2;
+        while (blockSize < bytes + alignment) {
+            blockSize *= 2;
+        }
+        auto *data = static_cast<std::byte *>(upstream->allocate(blockSize, alignof(std::max_align_t)));
+        blocks.push_back({data, blockSize});
+        blockIndex = blocks.size() - 1;
+        blockOffset = 0;
+        return allocateFromBlock(blocks.back(), bytes, alignment);
+    }
+
+
+    void do_deallocate(void *memory, size_t bytes, size_t alignment) override {
+        if (!isOwned(memory)) {
+            upstream->deallocate(memory, bytes, alignment);
+        }
+        //Memory of blocks is released all at once by reset
+    }
+
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+
+private:
+
+    /**
+     * @return Memory from the current block, nullptr when block has not enough space left.
+     * @since 1.0.0
+     */
+    void *allocateFromBlock(
+            const Block &block,
+            size_t bytes,
+            size_t alignment
+    ) {
+        auto address = reinterpret_cast<uintptr_t>(block.data) + blockOffset;
+        uintptr_t alignedAddress = (address + alignment - 1) & ~(alignment - 1);
+        size_t end = alignedAddress - reinterpret_cast<uintptr_t>(block.data) + bytes;
+        if (end > block.size) {
+            return nullptr;
+        }
+        blockOffset = end;
+        return reinterpret_cast<void *>(alignedAddress);
+    }
+
+
+    /**
+     * @return True when memory was taken from one of the blocks, false when it was taken from
+     * upstream resource while arena was bypassed.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isOwned(const void *memory) const {
+        const auto *address = static_cast<const std::byte *>(memory);
+        for (const Block &block: blocks) {
+            if (address >= block.data && address < block.data + block.size) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_DOCUMENTARENA_H
@@ -0,0 +1,277 @@
+#include <bitset>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HtmlIteratorCallback.h"
+#include "HtmlNames.h"
+#include "TagInfo.h"
+
+#ifndef ANDROID_HTML_ITERATOR_EVENTFILTER_H
+#define ANDROID_HTML_ITERATOR_EVENTFILTER_H
+
+
+/**
+ * Names of tags matched case insensitively. Well known tags are matched by their id, other tags by
+ * name, so matching well known tag costs single bit test.
+ * @since 1.0.0
+ */
+class TagNameSet {
+
+private:
+    std::bitset<256> tagIds;
+    std::vector<std::string> unknownNames;
+    bool isEmptySet = true;
+
+
+public:
+
+    void add(std::string_view name) {
+        htmlNames::TagId tagId = htmlNames::getTagId(name);
+        if (tagId != htmlNames::TagId::UNKNOWN) {
+            tagIds.set(static_cast<size_t>(tagId));
+        } else {
+            unknownNames.emplace_back(name);
+        }
+        isEmptySet = false;
+    }
+
+
+    template<typename CharT>
+    [[nodiscard]] bool contains(const BasicTagInfo<CharT> &tag) const {
+        if (tag.getTagId() != htmlNames::TagId::UNKNOWN) {
+            return tagIds.test(static_cast<size_t>(tag.getTagId()));
+        }
+        for (const std::string &name: unknownNames) {
+            if (htmlNames::equalsIgnoreCase(std::string_view(name), tag.getTag())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    [[nodiscard]] bool isEmpty() const {
+        return isEmptySet;
+    }
+};
+
+
+/**
+ * Decides which results of HtmlIterator are delivered, so results nobody asked for are dropped
+ * before they are converted for java. Filter is shared by iterators of both code unit types, so
+ * names are held as UTF-8.
+ * <ul>
+ * <li>Tags are delivered only when their name is in <code>reportedTags</code>, all tags when it's
+ * empty, and when they have all <code>requiredAttributes</code>.</li>
+ * <li>Content of pair tags named in <code>skippedTags</code> is skipped by iterator without being
+ * iterated, tags themselves are not delivered.</li>
+ * <li>Text is delivered only when <code>isTextReported</code> is true, including text of tags
+ * which are not delivered.</li>
+ * </ul>
+ * @since 1.0.0
+ */
+class EventFilter {
+
+private:
+    TagNameSet reportedTags;
+    TagNameSet skippedTags;
+    std::vector<std::string> requiredAttributes;
+    bool isTextReported = true;
+
+
+public:
+
+    void addReportedTag(std::string_view name) {
+        reportedTags.add(name);
+    }
+
+
+    void addSkippedTag(std::string_view name) {
+        skippedTags.add(name);
+    }
+
+
+    void addRequiredAttribute(std::string_view name) {
+        requiredAttributes.emplace_back(name);
+    }
+
+
+    void setTextReported(bool isReported) {
+        this->isTextReported = isReported;
+    }
+
+
+    [[nodiscard]] bool getIsTextReported() const {
+        return isTextReported;
+    }
+
+
+    /**
+     * @return True when filter lets all results through, so it doesn't have to be evaluated.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isEmpty() const {
+        return reportedTags.isEmpty()
+               && skippedTags.isEmpty()
+               && requiredAttributes.empty()
+               && isTextReported;
+    }
+
+
+    /**
+     * @return True when content of the tag is skipped, see <code>skippedTags</code>.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    [[nodiscard]] bool isSubtreeSkipped(const BasicTagInfo<CharT> &tag) const {
+        return !skippedTags.isEmpty() && skippedTags.contains(tag);
+    }
+
+
+    /**
+     * Attributes of the tag are parsed only when there are required attributes and name of the
+     * tag matches.
+     * @return True when tag is delivered.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    [[nodiscard]] bool isTagReported(const BasicTagInfo<CharT> &tag) const {
+        if (isSubtreeSkipped(tag)) {
+            return false;
+        }
+        if (!reportedTags.isEmpty() && !reportedTags.contains(tag)) {
+            return false;
+        }
+        for (const std::string &name: requiredAttributes) {
+            if (!hasAttribute(tag, name)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+private:
+
+    template<typename CharT>
+    [[nodiscard]] static bool hasAttribute(
+            const BasicTagInfo<CharT> &tag,
+            std::string_view name
+    ) {
+        for (const auto &[key, value]: tag.getOutMap()) {
+            if (htmlNames::equalsIgnoreCase(name, key)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+
+/**
+ * Callback evaluating <code>EventFilter</code> and passing only results accepted by the filter to
+ * <code>target</code>. Skipped pair tags are refused, so iterator skips their content without
+ * iterating it. Filter is evaluated again for leaving pair tag instead of tracking delivered tags,
+ * tag is the same instance, so the result is the same as long as the filter isn't changed in the
+ * middle of the content.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class FilteringCallback : public BasicHtmlIteratorCallback<CharT> {
+
+public:
+    using TagInfo = BasicTagInfo<CharT>;
+    using Callback = BasicHtmlIteratorCallback<CharT>;
+
+
+private:
+    const EventFilter *filter;
+    Callback *target;
+
+
+public:
+    FilteringCallback(
+            const EventFilter *filter,
+            Callback *target
+    ) : filter(filter), target(target) {
+    }
+
+
+    void setTarget(Callback *newTarget) {
+        this->target = newTarget;
+    }
+
+
+    void onContentText(std::basic_string<CharT> &text) override {
+        if (filter->getIsTextReported()) {
+            target->onContentText(text);
+        }
+    }
+
+
+    void onSingleTag(TagInfo &tag) override {
+        if (filter->isTagReported(tag)) {
+            target->onSingleTag(tag);
+        }
+    }
+
+
+    void onScript(TagInfo &tag) override {
+        if (filter->isTagReported(tag)) {
+            target->onScript(tag);
+        }
+    }
+
+
+    bool onPairTag(
+            TagInfo &tag,
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        if (filter->isSubtreeSkipped(tag)) {
+            return false;
+        }
+        if (!filter->isTagReported(tag)) {
+            //Tag itself is not delivered, but its content may be
+            return true;
+        }
+        return target->onPairTag(
+                tag,
+                openingTagStartIndex,
+                openingTagEndIndex,
+                closingTagStartIndex,
+                closingTagEndIndex
+        );
+    }
+
+
+    void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        if (filter->isTagReported(tag)) {
+            target->onLeavingPairTag(tag, closingTagStartIndex, closingTagEndIndex);
+        }
+    }
+
+
+    void onLeftPairTagText(
+            std::basic_string<CharT> &text,
+            TagInfo &tag
+    ) override {
+        if (!filter->getIsTextReported()) {
+            return;
+        }
+        if (filter->isTagReported(tag)) {
+            target->onLeftPairTagText(text, tag);
+        } else {
+            //Leaving of the tag was not delivered, so the text can't be related to it
+            target->onContentText(text);
+        }
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_EVENTFILTER_H
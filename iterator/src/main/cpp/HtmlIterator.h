@@ -2,12 +2,25 @@
 /// Created by Miroslav Hýbler on 22.11.2024
 ///
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <memory_resource>
 #include <string>
-#include <stack>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
 #include "HtmlIteratorCallback.h"
 #include "StringUtils.h"
 #include "TagInfo.h"
 #include "PlatformUtils.h"
+#include "StructuralIndex.h"
+#include "Diagnostics.h"
+#include "HtmlEntities.h"
+#include "DocumentArena.h"
+#include "MappedFile.h"
+#include "SpeculativeTokens.h"
+#include "TextExtractor.h"
 
 #ifndef ANDROID_HTML_ITERATOR_HTMLITERATOR_H
 #define ANDROID_HTML_ITERATOR_HTMLITERATOR_H
@@ -20,21 +33,54 @@
  * 2. iterateSingleIteration()<br>
  * 3. moveIndexToNextTag()<br>
  * 4. onTag()<br>
+ * <h3>Code units</h3>
+ * CharT is type of code units of the content. HtmlIterator iterates UTF-8 content (char), e.g.
+ * mapped files or byte buffers, HtmlIterator16 iterates UTF-16 content (char16_t) of java strings
+ * without transcoding it. All indexes are indexes of code units.
  * @since 1.0.0
  * @author Miroslav Hýbler <br>
  * created on 22.11.2024
  */
-class HtmlIterator {
+template<typename CharT>
+class BasicHtmlIterator {
+
+public:
+    using String = std::basic_string<CharT>;
+    using StringView = std::basic_string_view<CharT>;
+    using TagInfo = BasicTagInfo<CharT>;
+    using Callback = BasicHtmlIteratorCallback<CharT>;
+
 
 private:
+    using TokenType = typename SpeculativeTokens<CharT>::TokenType;
+    using Token = typename SpeculativeTokens<CharT>::Token;
+    using Segment = typename SpeculativeTokens<CharT>::Segment;
+
 
     /**
      * Holding current html content text. Is set by <code>setContent</code>. Can be whole html
      * document content most likely wrapped in <html> tag or can be a clip of html styled content
-     * to be processed.
+     * to be processed. It's a view into <code>contentStorage</code>, into <code>mappedFile</code> or
+     * into content borrowed by <code>setBorrowedContent</code>.
+     * @since 1.0.0
+     */
+    StringView content;
+
+
+    /**
+     * Owned copy of the content set by <code>setContent</code> or streamed by <code>feed</code>.
+     * Empty when content is mapped from file.
+     * @since 1.0.0
+     */
+    String contentStorage;
+
+
+    /**
+     * File mapped by <code>setContentFromFile</code>, content is read directly from the mapping
+     * without copying it.
      * @since 1.0.0
      */
-    std::string content;
+    MappedFile mappedFile;
 
 
     /**
@@ -44,27 +90,92 @@ private:
     size_t contentLength = 0;
 
 
+    /**
+     * Structural index of <code>content</code>, built by <code>setContent</code>. Used to jump
+     * between structural characters ('<', '>', quotes and comments) instead of reading content
+     * byte by byte.
+     * @since 1.0.0
+     */
+    StructuralIndex structuralIndex;
+
+
+    /**
+     * Tokens of big content lexed in parallel by <code>setContent</code>, empty for smaller or
+     * streamed content. Iterator uses token when it starts exactly where iterator is, see
+     * <code>SpeculativeTokens</code>.
+     * @since 1.0.0
+     */
+    SpeculativeTokens<CharT> speculativeTokens;
+
+
+    /**
+     * True when content of at least <code>PARALLEL_TOKENIZATION_MIN_LENGTH</code> is lexed in
+     * parallel, see <code>speculativeTokens</code>.
+     * @since 1.0.0
+     */
+    bool isParallelTokenizationEnabled = true;
+
+
+    /**
+     * Minimal length of content lexed in parallel, starting threads is not worth it for smaller
+     * content.
+     * @since 1.0.0
+     */
+    static constexpr size_t PARALLEL_TOKENIZATION_MIN_LENGTH = 1 << 20;
+
+
+    /**
+     * Memory of containers holding state of the current document, memory of the whole document like
+     * closing tag index and <code>tagPool</code>. It's reset by <code>clear</code> with capacity
+     * kept, so next document reuses the same memory. Must be declared before containers using it, so
+     * it outlives them.
+     * @since 1.0.0
+     */
+    DocumentArena arena;
+
+
+    /**
+     * Memory of <code>tagStack</code> and of tags in it, taken from <code>arena</code>. Arena never
+     * reuses released memory, so tags which are pushed and popped over and over would make it grow
+     * with count of tags in the document. Pool reuses memory of popped tags, so memory depends on
+     * nesting depth only.
+     * @since 1.0.0
+     */
+    std::pmr::unsynchronized_pool_resource tagPool{&arena};
+
+
     /**
      * Holding TagInfo of <b>pair</b> tags as they are iterated. Tags are pushed when iterator detects
-     * and enters pair tag and are popped out when iterator moves next behind the closing tag.
+     * and enters pair tag and are popped out when iterator moves next behind the closing tag. Closing
+     * tags are matched against this stack, so it's indexable to be able to search for unclosed tags
+     * deeper in the stack. It's deque, so tags stay at their address while other tags are pushed,
+     * callback can keep pointer to the tag until it leaves the tag.
+     * @since 1.0.0
+     */
+    std::pmr::deque<TagInfo> tagStack{&tagPool};
+
+
+    /**
+     * True when iterator found any <b>pair</b> tag already.
      * @since 1.0.0
      */
-    std::stack<TagInfo> tagStack;
+    bool isAnyPairTagFound = false;
 
 
     /**
-     * Holding TagInfo of <b>pair</b> tags as they are iterated. Unlike tagStack, tags are not popped
-     * out when iterator leaves pair tag.
+     * True when the last <b>pair</b> tag found by iterator is inline tag. Only classification of the
+     * previous tag is needed to adjust text, so tags are not kept once they are left.
      * @since 1.0.0
      */
-    std::stack<TagInfo> tagSequence;
+    bool isPreviousPairTagInline = false;
 
 
     /**
-     * Holds list of text content queried throught the process normalized based on context.
+     * Last char of the last text sent to callback, 0 when no text was sent yet. Only this char is
+     * needed to adjust following text, so texts are not kept.
      * @since 1.0.0
      */
-    std::stack<std::string> textNodes;
+    CharT previousTextLastChar = 0;
 
 
     /**
@@ -72,7 +183,7 @@ private:
      * will not continue because there is no where to deliver result, so whole process would be useless.
      * @since 1.0.0
      */
-    HtmlIteratorCallback *callback = nullptr;
+    Callback *callback = nullptr;
 
 
     /**
@@ -83,10 +194,10 @@ private:
 
 
     /**
-     * Holds text that have been queried between tags before it's pushed into [textNodes] stack.
+     * Holds text that have been queried between tags before it's sent to callback.
      * @since 1.0.0
      */
-    std::string currentTextNode;
+    String currentTextNode;
 
 
     /**
@@ -114,6 +225,122 @@ private:
     bool isFullHtmlDocument = false;
 
 
+    /**
+     * When true, index of closing tags is built before first pair tag is delivered, so
+     * <code>closingTagStartIndex</code> and <code>closingTagEndIndex</code> are available already in
+     * <code>onPairTag</code>. When false (default), pair tags are matched in single pass using
+     * <code>tagStack</code> and closing indexes are delivered only in <code>onLeavingPairTag</code>.
+     * @since 1.0.0
+     */
+    bool isClosingTagIndexEnabled = false;
+
+
+    /**
+     * Deferred closing tag index, maps index of opening tag '<' char to index of '<' char of its
+     * closing tag. Built by <code>buildClosingTagIndex</code> in one linear pass when first needed.
+     * Unclosed tags have no entry.
+     * @since 1.0.0
+     */
+    std::pmr::unordered_map<size_t, size_t> closingTagIndex{&arena};
+
+
+    /**
+     * True when <code>closingTagIndex</code> was already built for current content.
+     * @since 1.0.0
+     */
+    bool isClosingTagIndexBuilt = false;
+
+
+    /**
+     * Problems found in the content during iteration. Html content can have syntax errors, these
+     * are reported here without interrupting the iteration.
+     * @since 1.0.0
+     */
+    BasicDiagnostics<CharT> diagnostics;
+
+
+    /**
+     * Index of the first char of <code>content</code> within the whole input. Non zero only when
+     * content is streamed by <code>feed</code> and consumed part of the content was released. All
+     * indexes delivered to callback are relative to the whole input.
+     * @since 1.0.0
+     */
+    uint64_t contentOffset = 0;
+
+
+    /**
+     * True while content is streamed by <code>feed</code>, closing tag index is not available for
+     * streamed content.
+     * @since 1.0.0
+     */
+    bool isStreamingContent = false;
+
+
+    /**
+     * False while content is streamed by <code>feed</code> and <code>finish</code> was not called
+     * yet, so sequences at the end of <code>content</code> may be incomplete.
+     * @since 1.0.0
+     */
+    bool isInputComplete = true;
+
+
+    /**
+     * True when processing stopped on incomplete sequence (tag, comment, script, ...) at the end of
+     * streamed content, processing continues from <code>currentIndex</code> with next chunk.
+     * @since 1.0.0
+     */
+    bool isWaitingForInput = false;
+
+
+    /**
+     * True when <code>moveIndexToInitialPosition</code> was already done for current content.
+     * Streamed content may be too short for it in the first chunks.
+     * @since 1.0.0
+     */
+    bool isInitialPositionResolved = false;
+
+
+    /**
+     * True when callback refused to step into the last tag of <code>tagStack</code> and closing tag
+     * was not found in streamed content yet, content is skipped until closing tag is found.
+     * @since 1.0.0
+     */
+    bool isSkippingPairTag = false;
+
+
+    /**
+     * Count of nested tags of the same name as skipped tag which are opened while skipping, see
+     * <code>isSkippingPairTag</code>.
+     * @since 1.0.0
+     */
+    size_t skippedNestedTagsCount = 0;
+
+
+    /**
+     * Index from which closing tag of raw text tag (&lt;script&gt;, &lt;head&gt;) at
+     * <code>currentIndex</code> is searched, when streamed content ended before the closing tag.
+     * Content before it was searched already, so it's not searched again with every chunk. 0 when
+     * no raw text tag is waiting for input, see <code>findWaitingRawTextEnd</code>.
+     * @since 1.0.0
+     */
+    size_t rawTextResumeIndex = 0;
+
+
+    /**
+     * True while <code>extractText</code> is running, texts are written into
+     * <code>textExtractor</code> and nothing is delivered to the callback.
+     * @since 1.0.0
+     */
+    bool isExtractingText = false;
+
+
+    /**
+     * Collects plain text of the content while <code>isExtractingText</code> is true.
+     * @since 1.0.0
+     */
+    BasicTextExtractor<CharT> textExtractor;
+
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     /////
     /////   Public interface (constructors and functions)
@@ -122,10 +349,10 @@ private:
 
 
 public:
-    HtmlIterator() = default;
+    BasicHtmlIterator() = default;
 
 
-    ~HtmlIterator() {
+    ~BasicHtmlIterator() {
         clear();
     }
 
@@ -133,14 +360,127 @@ public:
     /**
      * Sets a new content for iterator, should be called together with @setCallback before @iterate.
      * Also all variables are reseted to initial state and all previous results are lost.
+     * @param newContent Content is copied, so it can be released right after the call.
+     * @since 1.0.0
+     */
+    void setContent(const StringView &newContent) {
+        clear();
+        this->contentStorage.append(newContent);
+        setContentView(this->contentStorage);
+    }
+
+
+    /**
+     * Same as <code>setContent</code>, content is moved into iterator instead of being copied.
      * @param newContent
      * @since 1.0.0
      */
-    void setContent(std::string &newContent) {
+    void setContent(String &&newContent) {
         clear();
-        this->content.append(newContent);
-        this->contentLength = newContent.length();
-        this->isFullHtmlDocument = moveIndexToInitialPosition();
+        this->contentStorage = std::move(newContent);
+        setContentView(this->contentStorage);
+    }
+
+
+    /**
+     * Sets a new content without copying it, see <code>setContent</code>. Iterator only borrows the
+     * content, caller must keep it alive and unchanged until content is cleared or another content
+     * is set.
+     * @param borrowedContent Content owned by caller.
+     * @since 1.0.0
+     */
+    void setBorrowedContent(const StringView &borrowedContent) {
+        clear();
+        setContentView(borrowedContent);
+    }
+
+
+    /**
+     * Sets content of the file at path as a new content, see <code>setContent</code>. File is
+     * memory mapped and iterated without copying it, so it has to stay unchanged until content is
+     * cleared.
+     * @param path Path to the file.
+     * @return True when content was set, false when file can't be opened or mapped.
+     * @since 1.0.0
+     */
+    bool setContentFromFile(const std::string &path) {
+        static_assert(std::is_same_v<CharT, char>, "Only UTF-8 content can be mapped from file");
+        clear();
+        if (!this->mappedFile.open(path)) {
+            return false;
+        }
+        setContentView(this->mappedFile.getContent());
+        return true;
+    }
+
+
+    /**
+     * Sets content of the file opened by fd as a new content, see <code>setContentFromFile</code>.
+     * Descriptor stays owned by caller and can be closed right after the call.
+     * @param fd Descriptor of file opened for reading.
+     * @return True when content was set, false when file can't be mapped.
+     * @since 1.0.0
+     */
+    bool setContentFromFileDescriptor(int fd) {
+        static_assert(std::is_same_v<CharT, char>, "Only UTF-8 content can be mapped from file");
+        clear();
+        if (!this->mappedFile.open(fd)) {
+            return false;
+        }
+        setContentView(this->mappedFile.getContent());
+        return true;
+    }
+
+
+    /**
+     * Appends chunk of streamed content and delivers all steps which are complete to the callback,
+     * so callback has to be set before. Incomplete sequence at the end of the chunk (tag, comment,
+     * script, ...) is kept and processed with next chunk. Consumed part of the content is released,
+     * so memory is bounded by chunk size and opened tags instead of whole content. First call after
+     * <code>setContent</code>, <code>finish</code> or <code>clear</code> starts new content.
+     * <br>
+     * Closing tag index is not available for streamed content.
+     * @param chunk Next part of the content.
+     * @since 1.0.0
+     */
+    void feed(const StringView &chunk) {
+        if (isFeedStartingNewContent()) {
+            clear();
+            this->isStreamingContent = true;
+            this->isInputComplete = false;
+            //Streamed content has no end known in advance, released memory has to be returned
+            //right away to keep memory bounded
+            this->arena.setBypassed(true);
+        }
+        this->contentStorage.append(chunk);
+        this->content = this->contentStorage;
+        this->contentLength = this->content.length();
+        //Retained content is indexed already, only the chunk is indexed
+        this->structuralIndex.append(this->content.data(), this->contentLength);
+        processAvailableContent();
+    }
+
+
+    /**
+     * @return True when next <code>feed</code> starts new content, so the current content with its
+     * tags is cleared by it. It's true when content is not streamed or stream was finished.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isFeedStartingNewContent() const {
+        return !this->isStreamingContent || this->isInputComplete;
+    }
+
+
+    /**
+     * Marks streamed content as complete and delivers the rest of the steps, see <code>feed</code>.
+     * @since 1.0.0
+     */
+    void finish() {
+        if (!this->isStreamingContent || this->isInputComplete) {
+            return;
+        }
+        this->isInputComplete = true;
+        processAvailableContent();
     }
 
 
@@ -150,304 +490,1114 @@ public:
      * @param newCallback
      * @since 1.0.0
      */
-    void setCallback(HtmlIteratorCallback *newCallback) {
-        this->callback = newCallback;
+    void setCallback(Callback *newCallback) {
+        this->callback = newCallback;
+    }
+
+
+    /**
+     * Enables or disables deferred closing tag index, see <code>isClosingTagIndexEnabled</code>.
+     * @param isEnabled True to have closing tag indexes available in <code>onPairTag</code>.
+     * @since 1.0.0
+     */
+    void setClosingTagIndexEnabled(bool isEnabled) {
+        this->isClosingTagIndexEnabled = isEnabled;
+    }
+
+
+    /**
+     * @return True when closing tag indexes are available in <code>onPairTag</code>.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool getIsClosingTagIndexEnabled() const {
+        return this->isClosingTagIndexEnabled;
+    }
+
+
+    /**
+     * Enables or disables parallel lexing of big content, see <code>speculativeTokens</code>. Has
+     * effect for the next content.
+     * @param isEnabled True to lex content of at least 1 MB in parallel (default).
+     * @since 1.0.0
+     */
+    void setParallelTokenizationEnabled(bool isEnabled) {
+        this->isParallelTokenizationEnabled = isEnabled;
+    }
+
+
+    /**
+     * @return True when big content is lexed in parallel, see <code>speculativeTokens</code>.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool getIsParallelTokenizationEnabled() const {
+        return this->isParallelTokenizationEnabled;
+    }
+
+
+    /**
+     * @return Count of bytes held by <code>arena</code> for state of the document. It depends on
+     * nesting depth of the content, not on its length.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t getArenaCapacity() const {
+        return this->arena.getCapacity();
+    }
+
+
+    /**
+     * @return Problems found in the content so far, cleared with the content.
+     * @since 1.0.0
+     */
+    [[nodiscard]] const BasicDiagnostics<CharT> &getDiagnostics() const {
+        return this->diagnostics;
+    }
+
+
+    /**
+     * Clear the resources used to release memory and resets all the variables into initial state.
+     * @since 1.0.0
+     */
+    void clear() {
+        this->content = {};
+        this->contentStorage.clear();
+        this->mappedFile.close();
+        this->structuralIndex.clear();
+        this->speculativeTokens.clear();
+        this->currentTextNode.clear();
+        this->contentLength = 0;
+        this->contentLength = 0;
+
+        this->isClosingTagIndexBuilt = false;
+        this->diagnostics.clear();
+        this->contentOffset = 0;
+        this->isStreamingContent = false;
+        this->isInputComplete = true;
+        this->isWaitingForInput = false;
+        this->isInitialPositionResolved = false;
+        this->isSkippingPairTag = false;
+        this->skippedNestedTagsCount = 0;
+        this->rawTextResumeIndex = 0;
+        this->textExtractor.clear();
+        //Memory of the document is reused by the next one, capacity of the arena is kept. Tags are
+        //destroyed before their pool returns its memory into the arena.
+        std::destroy_at(&this->tagStack);
+        this->tagPool.release();
+        this->arena.resetWith(closingTagIndex);
+        new(&this->tagStack) std::pmr::deque<TagInfo>(&this->tagPool);
+        this->isAnyPairTagFound = false;
+        this->isPreviousPairTagInline = false;
+        this->previousTextLastChar = 0;
+
+        this->currentIndex = 0;
+        this->contentLength = 0;
+        this->isPreContext = false;
+        this->isHeadIterated = false;
+        this->isFullHtmlDocument = false;
+    }
+
+
+    /**
+     * Starts iteration through whole content which was set by @setContent before. Results are delivered
+     * via @callback which was set by @setCallback before.
+     * @since 1.0.0
+     */
+    //TODO more docs about whole process
+    void iterate() {
+        platformUtils::log("HtmlIterator", "HtmlIterator::iterate()");
+
+        if (callback == nullptr) {
+            platformUtils::log("HtmlIterator", "Unable to iterate, callback is null!");
+            return;
+        }
+
+        bool canIterate;
+        do {
+            canIterate = iterateSingleIteration();
+        } while (canIterate);
+        platformUtils::log("HtmlIterator", "HtmlIterator::iterate() -- done");
+    }
+
+
+    /**
+     * Iterates whole content set by @setContent before and returns its visible text instead of
+     * delivering steps to callback, so callback doesn't have to be set. Text follows the same white
+     * chars rules as texts delivered by <code>onContentText</code>, texts of block tags are
+     * separated by line or paragraph breaks. Scripts and content of hidden tags like
+     * <code>&lt;style&gt;</code> are skipped, tags are only matched, their attributes are never
+     * parsed.
+     * @return Plain text of the content.
+     * @since 1.0.0
+     */
+    [[nodiscard]] String extractText() {
+        this->isExtractingText = true;
+        this->textExtractor.clear();
+        bool canIterate;
+        do {
+            canIterate = iterateSingleIteration();
+        } while (canIterate);
+        if (!currentTextNode.empty()) {
+            //Text behind the last tag, e.g. in content without tags, has no tag to be delivered by
+            textExtractor.appendText(currentTextNode, isPreContext);
+            currentTextNode.clear();
+        }
+        this->isExtractingText = false;
+        return this->textExtractor.takeText();
+    }
+
+
+    /**
+     *
+     * @return True if next iteration is possible, false otherwise.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool iterateSingleIteration() {
+        if (isSkippingPairTag) {
+            continueSkippingPairTag();
+        } else {
+            bool isTag = moveIndexToNextTag();
+            if (isTag) {
+                //Incoming sequence is html tag, need to obtain information about it
+                onTag();
+            }
+        }
+
+        if (isWaitingForInput) {
+            //Streamed content continues in next chunk
+            return false;
+        }
+
+        if (currentIndex < contentLength) {
+            return true;
+        }
+
+        if (!isInputComplete) {
+            return false;
+        }
+        //End of the content, all tags left in the stack are unclosed
+        closeUnclosedPairTags();
+        return false;
+    }
+
+
+    /**
+     *
+     * @return True if content set by setContent() is full html document, false when content is only
+     * html styled content.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isContentFullHtmlDocument() const {
+        return this->isFullHtmlDocument;
+    }
+
+
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    /////
+    /////   Private Functions
+    /////
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+private:
+
+
+    /**
+     * Sets view of the whole content and resolves initial position for iteration.
+     * @param newContent View into <code>contentStorage</code>, <code>mappedFile</code> or borrowed
+     * content.
+     * @since 1.0.0
+     */
+    void setContentView(StringView newContent) {
+        this->content = newContent;
+        this->contentLength = newContent.length();
+        this->structuralIndex.build(this->content.data(), this->contentLength);
+        if (isParallelTokenizationEnabled && contentLength >= PARALLEL_TOKENIZATION_MIN_LENGTH) {
+            WorkStealingPool pool;
+            if (pool.getWorkersCount() > 1) {
+                speculativeTokens.build(contentLength, pool, [this](size_t s, size_t e, auto &segment) {
+                    lexSegment(s, e, segment);
+                });
+            }
+        }
+        this->isFullHtmlDocument = moveIndexToInitialPosition();
+        this->isInitialPositionResolved = true;
+    }
+
+
+    /**
+     * Delivers all complete steps of streamed content to the callback and releases consumed part
+     * of the content.
+     * @since 1.0.0
+     */
+    void processAvailableContent() {
+        if (callback == nullptr) {
+            platformUtils::log("HtmlIterator", "Unable to iterate, callback is null!");
+            return;
+        }
+        isWaitingForInput = false;
+
+        if (!isInitialPositionResolved) {
+            isFullHtmlDocument = moveIndexToInitialPosition();
+            if (isWaitingForInput) {
+                //Start of the content is not complete yet, nothing was delivered so far
+                currentIndex = 0;
+                currentTextNode.clear();
+                return;
+            }
+            isInitialPositionResolved = true;
+        }
+
+        bool canIterate;
+        do {
+            canIterate = iterateSingleIteration();
+        } while (canIterate);
+
+        if (!isInputComplete) {
+            releaseConsumedContent();
+        }
+    }
+
+
+    /**
+     * Releases part of the content before <code>currentIndex</code>. Tags in <code>tagStack</code>
+     * are pointing to released part, so they take copy of their body first.
+     * @since 1.0.0
+     */
+    void releaseConsumedContent() {
+        if (currentIndex == 0) {
+            return;
+        }
+
+        for (TagInfo &tag: tagStack) {
+            tag.ownBody();
+        }
+        contentStorage.erase(0, currentIndex);
+        content = contentStorage;
+        contentOffset += currentIndex;
+        contentLength = content.length();
+        structuralIndex.erasePrefix(currentIndex);
+        //Raw text tag waiting for input is at currentIndex, so its resume index is not released
+        if (rawTextResumeIndex != 0) {
+            rawTextResumeIndex -= currentIndex;
+        }
+        currentIndex = 0;
+    }
+
+
+    /**
+     * Called when sequence at index is incomplete because content ended.
+     * @return True when content is streamed and may continue in next chunk, processing has to
+     * wait for it. False when content is complete, so sequence is malformed.
+     * @since 1.0.0
+     */
+    bool waitForInput() {
+        if (isInputComplete) {
+            return false;
+        }
+        isWaitingForInput = true;
+        return true;
+    }
+
+
+    /**
+     * @param i Index into <code>content</code>.
+     * @return Index relative to the whole input, 64 bit even on 32 bit platforms as streamed or
+     * mapped input may be bigger than 4 GB. <code>UINT64_MAX</code> when i is npos.
+     * @since 1.0.0
+     */
+    [[nodiscard]] uint64_t toInputIndex(size_t i) const {
+        return i != std::string::npos ? i + contentOffset : UINT64_MAX;
+    }
+
+
+    /**
+     * Tries to move currentIndex into next html tag. Technically it moves to the next '<' character
+     * and checks if its tag or not. Also queries all text content depend on context. Next '<'
+     * character is obtained from <code>structuralIndex</code>.
+     * @return True when sequence starting at i is tag to be processed, false otherwise
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool moveIndexToNextTag() {
+        const auto *textToken = speculativeTokens.find(currentIndex);
+        size_t textEndIndex;
+        if (textToken != nullptr && textToken->type == TokenType::TEXT && !isPreContext) {
+            appendTokenText(*textToken);
+            textEndIndex = textToken->end;
+        } else {
+            size_t nextTagStartIndex = structuralIndex.nextTagStart(currentIndex);
+            textEndIndex = nextTagStartIndex != std::string::npos
+                           ? nextTagStartIndex
+                           : contentLength;
+            size_t referenceIndex = textEndIndex;
+            if (nextTagStartIndex == std::string::npos && !isInputComplete) {
+                referenceIndex = currentIndex + htmlEntities::findIncompleteReference(
+                        content.substr(currentIndex, textEndIndex - currentIndex)
+                );
+            }
+            tryAppendTextToContent(currentIndex, referenceIndex);
+            if (referenceIndex < textEndIndex) {
+                //Character reference at the end of the chunk may continue in the next chunk
+                currentIndex = referenceIndex;
+                waitForInput();
+                return false;
+            }
+        }
+        currentIndex = textEndIndex;
+        if (textEndIndex >= contentLength) {
+            return false;
+        }
+        //In this line, current char is < meaning that we are probably at the start of tag
+        size_t outIndex = currentIndex;
+        bool isTag;
+        const auto *token = speculativeTokens.find(currentIndex);
+        if (token != nullptr && token->type != TokenType::TEXT) {
+            isTag = token->type == TokenType::TAG;
+            outIndex = token->end;
+        } else {
+            isTag = canProcessIncomingSequence(contentLength, currentIndex, outIndex);
+        }
+
+        if (!isTag && !isWaitingForInput) {
+            currentIndex = outIndex + 1;
+        }
+        return isTag;
+    }
+
+
+    /**
+     * Called from moveIndexToNextTag() when currentIndex is pointing to '<' char and sequence after it is valid
+     * html tag (validated by canProcessIncomingSequence). Extracts current tag info into currentTagInfo and
+     * call callback method to deliver result.
+     * <br>
+     * Pair tags are matched with their closing tags in single pass using <code>tagStack</code>, so
+     * content is never scanned ahead for the closing tag unless callback refuses to step into the
+     * pair tag, see <code>skipPairTagContent</code>.
+     * @since 1.0.0
+     */
+    //TODO create new function for processing tag and delivering result
+    void onTag() {
+        const auto *token = speculativeTokens.find(currentIndex);
+        size_t tagEndIndex = token != nullptr && token->type == TokenType::TAG
+                             ? token->end
+                             : findTagEnd(currentIndex);
+        if (tagEndIndex == std::string::npos) {
+            if (waitForInput()) {
+                return;
+            }
+            //Content is not containing another tag, pair tags left are closed at the end
+            diagnostics.report(DiagnosticCode::UNTERMINATED_TAG, toInputIndex(currentIndex), {});
+            currentIndex = contentLength;
+            return;
+        }
+        // -1 to remove '>' at the end
+        size_t tagBodyLength = tagEndIndex - currentIndex - 1;
+        //tag body within <>, currentIndex + 1 to remove '<'
+        StringView currentTagBody = content.substr(
+                currentIndex + 1,
+                tagBodyLength
+        );
+        StringView tag = htmlUtils::getTagName(currentTagBody);
+        bool isClosing = stringUtils::startsWith(tag, '/');
+
+        if (isFullHtmlDocument && !isHeadIterated) {
+            //Skipping head tag
+            //TODO maybe remove skipping head tag
+            if (htmlNames::getTagId(tag) == htmlNames::TagId::HEAD) {
+                //index of < of closing tag, head can't contain another head so there is no need
+                //to match nested tags
+                size_t closingTagStartIndex = findWaitingRawTextEnd(tag, tagEndIndex + 1);
+                size_t closingTagEndIndex = closingTagStartIndex != std::string::npos
+                                            ? structuralIndex.nextTagEnd(closingTagStartIndex)
+                                            : std::string::npos;
+                if (closingTagEndIndex == std::string::npos && waitForInput()) {
+                    return;
+                }
+                rawTextResumeIndex = 0;
+                isHeadIterated = true;
+                if (closingTagEndIndex == std::string::npos) {
+                    //Html content can have syntax errors like unclosed pair tags or others,
+                    //so library should keep going, browsers are also ignoring these errors
+                    //Just keep parsing, just keep parsing
+                    diagnostics.report(DiagnosticCode::UNCLOSED_RAW_TEXT_TAG, toInputIndex(currentIndex), tag);
+                    currentIndex = tagEndIndex + 1;
+                    return;
+                }
+                currentIndex = closingTagEndIndex + 1;
+                return;
+            }
+        }
+
+
+        if (isClosing) {
+            //tag.substr(1) to remove '/' from the tag name
+            onClosingTag(tag.substr(1), currentIndex, tagEndIndex);
+            currentIndex = tagEndIndex + 1;
+            return;
+        }
+
+        //Extracts tag info from current tag body
+        TagInfo info = TagInfo(tag, currentTagBody);
+
+        size_t scriptEndIndex = std::string::npos;
+        if (info.getTagId() == htmlNames::TagId::SCRIPT) {
+            //Whole script has to be available before anything is delivered
+            scriptEndIndex = findWaitingRawTextEnd(tag, tagEndIndex + 1);
+            bool isScriptComplete = scriptEndIndex != std::string::npos
+                                    && structuralIndex.nextTagEnd(scriptEndIndex) != std::string::npos;
+            if (!isScriptComplete && waitForInput()) {
+                return;
+            }
+            rawTextResumeIndex = 0;
+        }
+
+        trySendContentText(info, false);
+
+        if (info.isSingleTag()) {
+            if (isExtractingText) {
+                textExtractor.onTagBoundary(info);
+            } else {
+                callback->onSingleTag(info);
+            }
+            currentIndex = tagEndIndex + 1;
+            return;
+        }
+
+        //TODO unit test
+        if (info.getTagId() == htmlNames::TagId::SCRIPT) {
+            //Script content is raw text without nested tags, closing tag can be searched directly
+            size_t closingTagStartIndex = scriptEndIndex;
+            info.setPairContent(toInputIndex(tagEndIndex + 1), toInputIndex(closingTagStartIndex));
+            if (!isExtractingText) {
+                callback->onScript(info);
+            }
+
+            size_t closingTagEndIndex = closingTagStartIndex != std::string::npos
+                                        ? structuralIndex.nextTagEnd(closingTagStartIndex)
+                                        : std::string::npos;
+            if (closingTagEndIndex == std::string::npos) {
+                diagnostics.report(DiagnosticCode::UNCLOSED_RAW_TEXT_TAG, toInputIndex(currentIndex), tag);
+            }
+            currentIndex = closingTagEndIndex != std::string::npos
+                           ? closingTagEndIndex + 1
+                           : contentLength;
+            return;
+        }
+
+        //TODO unit test
+        if (info.getTagId() == htmlNames::TagId::PRE) {
+            isPreContext = true;
+        }
+
+        //Closing tag indexes are known here only when closing tag index is enabled, otherwise they
+        //are delivered in onLeavingPairTag
+        size_t closingTagStartIndex = std::string::npos;
+        size_t closingTagEndIndex = std::string::npos;
+        if (isClosingTagIndexEnabled && !isStreamingContent) {
+            closingTagStartIndex = getIndexedClosingTag(currentIndex);
+            if (closingTagStartIndex != std::string::npos) {
+                closingTagEndIndex = structuralIndex.nextTagEnd(closingTagStartIndex);
+            }
+        }
+
+        info.setPairContent(
+                toInputIndex(tagEndIndex + 1),
+                toInputIndex(closingTagStartIndex)
+        );
+
+        //Callback gets the instance from the stack, so attributes parsed by callback are cached
+        //for onLeavingPairTag too
+        tagStack.push_back(info);
+        bool stepInto;
+        if (isExtractingText) {
+            textExtractor.onTagBoundary(info);
+            stepInto = !BasicTextExtractor<CharT>::isHiddenTag(info);
+        } else {
+            stepInto = callback->onPairTag(
+                    tagStack.back(),
+                    toInputIndex(currentIndex),
+                    toInputIndex(tagEndIndex),
+                    toInputIndex(closingTagStartIndex),
+                    toInputIndex(closingTagEndIndex)
+            );
+        }
+        isAnyPairTagFound = true;
+        isPreviousPairTagInline = tagStack.back().hasFlag(htmlNames::TAG_FLAG_INLINE);
+
+        currentIndex = tagEndIndex + 1;
+        if (!stepInto) {
+            skipPairTagContent(closingTagStartIndex);
+        }
+    }
+
+
+    /**
+     * Called from onTag() when closing tag is found. Matches closing tag with the nearest opened tag
+     * of the same name in <code>tagStack</code>. All tags above the matched one are considered
+     * unclosed and are closed by this closing tag too. Closing tag without any opened tag of the
+     * same name is ignored.
+     * @param tagName Name of the closing tag without '/'.
+     * @param closingTagStartIndex Index of '<' char of closing tag.
+     * @param closingTagEndIndex Index of '>' char of closing tag.
+     * @since 1.0.0
+     */
+    void onClosingTag(
+            const StringView &tagName,
+            size_t closingTagStartIndex,
+            size_t closingTagEndIndex
+    ) {
+        htmlNames::TagId tagId = htmlNames::getTagId(tagName);
+        size_t depth = tagStack.size();
+        while (depth > 0 && !isSameTag(tagStack[depth - 1].getTag(), tagStack[depth - 1].getTagId(), tagName, tagId)) {
+            depth -= 1;
+        }
+
+        if (depth == 0) {
+            //Closing tag without opening one, browsers are ignoring these too
+            diagnostics.report(DiagnosticCode::UNEXPECTED_CLOSING_TAG, toInputIndex(closingTagStartIndex), tagName);
+            return;
+        }
+
+        while (tagStack.size() > depth) {
+            //Tags above the matched one are unclosed, closed by this closing tag
+            diagnostics.report(DiagnosticCode::UNCLOSED_PAIR_TAG, toInputIndex(closingTagStartIndex), tagStack.back().getTag());
+            popPairTag(closingTagStartIndex, closingTagEndIndex);
+        }
+        popPairTag(closingTagStartIndex, closingTagEndIndex);
+    }
+
+
+    /**
+     * Pops the last tag from <code>tagStack</code> and delivers <code>onLeavingPairTag</code> with
+     * closing tag indexes.
+     * @param closingTagStartIndex Index of '<' char of closing tag.
+     * @param closingTagEndIndex Index of '>' char of closing tag.
+     * @since 1.0.0
+     */
+    void popPairTag(
+            size_t closingTagStartIndex,
+            size_t closingTagEndIndex
+    ) {
+        TagInfo &lastTag = tagStack.back();
+        lastTag.setPairContent(
+                lastTag.getPairContentStartIndex(),
+                toInputIndex(closingTagStartIndex)
+        );
+        if (!isExtractingText) {
+            callback->onLeavingPairTag(
+                    lastTag,
+                    toInputIndex(closingTagStartIndex),
+                    toInputIndex(closingTagEndIndex)
+            );
+        }
+
+        trySendContentText(lastTag, true);
+        if (isExtractingText) {
+            //Text of the tag was delivered after leaving, break goes behind it
+            textExtractor.onTagBoundary(lastTag);
+        }
+
+        if (lastTag.getTagId() == htmlNames::TagId::PRE) {
+            isPreContext = false;
+        }
+
+        tagStack.pop_back();
+    }
+
+
+    /**
+     * Called when iterator reaches end of the content. Tags left in <code>tagStack</code> were never
+     * closed, they are closed at the end of the content.
+     * @since 1.0.0
+     */
+    void closeUnclosedPairTags() {
+        while (!tagStack.empty()) {
+            diagnostics.report(DiagnosticCode::UNCLOSED_PAIR_TAG, toInputIndex(contentLength), tagStack.back().getTag());
+            popPairTag(contentLength, contentLength);
+        }
+    }
+
+
+    /**
+     * Called when callback refused to step into pair tag. Moves <code>currentIndex</code> right to
+     * the closing tag, so the closing tag is processed as usual and tag is popped from the
+     * <code>tagStack</code>. Looking ahead for the closing tag is linear here as the skipped content
+     * is never iterated again.
+     * @param closingTagStartIndex Index of '<' of closing tag if already known, std::string::npos
+     * otherwise.
+     * @since 1.0.0
+     */
+    void skipPairTagContent(size_t closingTagStartIndex) {
+        if (closingTagStartIndex == std::string::npos) {
+            isSkippingPairTag = true;
+            skippedNestedTagsCount = 0;
+            continueSkippingPairTag();
+            return;
+        }
+        currentIndex = closingTagStartIndex;
     }
 
 
     /**
-     * Clear the resources used to release memory and resets all the variables into initial state.
+     * Looks for closing tag of skipped tag, the last one in <code>tagStack</code>, from
+     * <code>currentIndex</code>. Streamed content is skipped chunk by chunk until the closing tag is
+     * found, see <code>isSkippingPairTag</code>.
      * @since 1.0.0
      */
-    void clear() {
-        this->content.clear();
-        this->currentTextNode.clear();
-        this->contentLength = 0;
-        this->contentLength = 0;
+    void continueSkippingPairTag() {
+        size_t resumeIndex = currentIndex;
+        size_t closingTagStartIndex = findClosingTag(
+                tagStack.back().getTag(),
+                currentIndex,
+                contentLength,
+                contentLength,
+                skippedNestedTagsCount,
+                resumeIndex
+        );
 
-        while (!this->tagStack.empty()) {
-            this->tagStack.pop();
-        }
-        while (!this->tagSequence.empty()) {
-            this->tagSequence.pop();
+        if (closingTagStartIndex != std::string::npos) {
+            isSkippingPairTag = false;
+            currentIndex = closingTagStartIndex;
+            return;
         }
 
-        while (!this->textNodes.empty()) {
-            this->textNodes.pop();
+        if (waitForInput()) {
+            currentIndex = resumeIndex;
+            return;
         }
 
-        this->currentIndex = 0;
-        this->contentLength = 0;
-        this->isPreContext = false;
-        this->isHeadIterated = false;
-        this->isFullHtmlDocument = false;
+        //Tag is unclosed till the end of the content, it's reported when closed at the end
+        isSkippingPairTag = false;
+        currentIndex = contentLength;
     }
 
 
     /**
-     * Starts iteration through whole content which was set by @setContent before. Results are delivered
-     * via @callback which was set by @setCallback before.
+     * @param tagName Name of the closing tag without '/'.
+     * @return True when closing tag closes any of the tags in <code>tagStack</code> below the last
+     * one.
      * @since 1.0.0
      */
-    //TODO more docs about whole process
-    void iterate() {
-        platformUtils::log("HtmlIterator", "HtmlIterator::iterate()");
-
-        if (callback == nullptr) {
-            platformUtils::log("HtmlIterator", "Unable to iterate, callback is null!");
-            return;
+    [[nodiscard]] bool isClosingParentTag(const StringView &tagName) const {
+        if (tagStack.empty()) {
+            return false;
         }
-
-        bool canIterate;
-        do {
-            canIterate = iterateSingleIteration();
-        } while (canIterate);
-        platformUtils::log("HtmlIterator", "HtmlIterator::iterate() -- done");
+        htmlNames::TagId tagId = htmlNames::getTagId(tagName);
+        for (size_t depth = tagStack.size() - 1; depth > 0; depth--) {
+            const TagInfo &parent = tagStack[depth - 1];
+            if (isSameTag(parent.getTag(), parent.getTagId(), tagName, tagId)) {
+                return true;
+            }
+        }
+        return false;
     }
 
 
     /**
-     *
-     * @return True if next iteration is possible, false otherwise.
+     * Returns index of the closing tag for pair tag starting at openingTagStartIndex from
+     * <code>closingTagIndex</code>. Index is built on the first call for the content.
+     * @param openingTagStartIndex Index of '<' char of opening tag.
+     * @return Index of '<' char of the closing tag, std::string::npos when tag is unclosed.
      * @since 1.0.0
      */
-    [[nodiscard]] bool iterateSingleIteration() {
-        bool isTag = moveIndexToNextTag();
-        if (isTag) {
-            //Incoming sequence is html tag, need to obtain information about it
-            onTag();
+    [[nodiscard]] size_t getIndexedClosingTag(size_t openingTagStartIndex) {
+        if (!isClosingTagIndexBuilt) {
+            buildClosingTagIndex();
         }
-        return currentIndex < contentLength;
+
+        auto result = closingTagIndex.find(openingTagStartIndex);
+        if (result == closingTagIndex.end()) {
+            return std::string::npos;
+        }
+        return result->second;
     }
 
 
     /**
-     *
-     * @return True if content set by setContent() is full html document, false when content is only
-     * html styled content.
+     * Builds <code>closingTagIndex</code> in one linear pass through the content using the same
+     * rules for matching tags as <code>onClosingTag</code>.
      * @since 1.0.0
      */
-    [[nodiscard]] bool isContentFullHtmlDocument() const {
-        return this->isFullHtmlDocument;
-    }
+    void buildClosingTagIndex() {
+        struct OpenedTag {
+            StringView tag;
+            htmlNames::TagId tagId;
+            size_t startIndex;
+        };
+        std::pmr::vector<OpenedTag> openedTags(&arena);
+        size_t i = 0;
+        size_t outIndex;
 
+        while (i < contentLength) {
+            i = structuralIndex.nextTagStart(i);
+            if (i == std::string::npos) {
+                break;
+            }
 
+            if (!canProcessIncomingSequence(contentLength, i, outIndex)) {
+                i = outIndex + 1;
+                continue;
+            }
 
-    ////////////////////////////////////////////////////////////////////////////////////////////////
-    /////
-    /////   Private Functions
-    /////
-    ////////////////////////////////////////////////////////////////////////////////////////////////
+            size_t tagEndIndex = findTagEnd(i);
+            if (tagEndIndex == std::string::npos) {
+                break;
+            }
 
+            StringView tagBody = content.substr(i + 1, tagEndIndex - i - 1);
+            StringView tag = htmlUtils::getTagName(tagBody);
 
-private:
+            if (tag.empty()) {
+                i = tagEndIndex + 1;
+                continue;
+            }
+
+            htmlNames::TagId tagId = htmlNames::getTagId(tag[0] == '/' ? tag.substr(1) : tag);
+
+            if (tag[0] == '/') {
+                size_t depth = openedTags.size();
+                while (depth > 0 && !isSameTag(openedTags[depth - 1].tag, openedTags[depth - 1].tagId, tag.substr(1), tagId)) {
+                    depth -= 1;
+                }
+
+                if (depth > 0) {
+                    closingTagIndex[openedTags[depth - 1].startIndex] = i;
+                    //Tags above matched one are unclosed and stay without entry
+                    openedTags.resize(depth - 1);
+                }
+            } else if (tagId == htmlNames::TagId::SCRIPT) {
+                size_t closingTagStartIndex = findRawTextEnd(tag, tagEndIndex + 1);
+                if (closingTagStartIndex == std::string::npos) {
+                    break;
+                }
+                closingTagIndex[i] = closingTagStartIndex;
+                tagEndIndex = closingTagStartIndex;
+            } else if (!stringUtils::endsWith(tagBody, '/')
+                       && (htmlNames::getTagFlags(tagId) & htmlNames::TAG_FLAG_VOID) == 0) {
+                openedTags.push_back({tag, tagId, i});
+            }
+            i = tagEndIndex + 1;
+        }
+
+        isClosingTagIndexBuilt = true;
+    }
 
 
     /**
-     * Tries to move currentIndex into next html tag. Technically it moves to the next '<' character
-     * and checks if its tag or not. Also queries all text content depend on context.
-     * @return True when sequence starting at i is tag to be processed, false otherwise
+     * Finds closing tag of element with raw text content, like &lt;script&gt; or &lt;head&gt;,
+     * which can't contain nested tag of the same name.
+     * @param tag Name of the tag.
+     * @param s Start index, should be index right after opening tag.
+     * @return Index of '<' char of closing tag, std::string::npos when not found.
      * @since 1.0.0
      */
-    [[nodiscard]] bool moveIndexToNextTag() {
-        char ch = content[currentIndex];
-        while (ch != '<' && currentIndex < contentLength) {
-            tryAppendCharToContent(ch);
-            ch = content[++currentIndex];
-        }
-        //In this line, current char is < meaning that we are probably at the start of tag
-        size_t outIndex;
-        bool isTag = canProcessIncomingSequence(contentLength, currentIndex, outIndex);
-
-        if (!isTag) {
-            currentIndex = outIndex + 1;
+    [[nodiscard]] size_t findRawTextEnd(
+            const StringView &tag,
+            size_t s
+    ) const {
+        size_t i = structuralIndex.nextTagStart(s);
+        while (i != std::string::npos) {
+            if (i + 1 < contentLength && content[i + 1] == '/'
+                && htmlNames::equalsIgnoreCase(content.substr(i + 2, tag.length()), tag)) {
+                return i;
+            }
+            i = structuralIndex.nextTagStart(i + 1);
         }
-        return isTag;
+        return std::string::npos;
     }
 
 
     /**
-     * Called from moveIndexToNextTag() when currentIndex is pointing to '<' char and sequence after it is valid
-     * html tag (validated by canProcessIncomingSequence). Extracts current tag info into currentTagInfo and
-     * call callback method to deliver result.
+     * Same as <code>findRawTextEnd</code> for raw text tag at <code>currentIndex</code>, which may
+     * wait for next chunks of streamed content. Search continues from
+     * <code>rawTextResumeIndex</code>, so content retained while waiting is searched only once.
+     * Caller resets <code>rawTextResumeIndex</code> when it stops waiting.
+     * @param tag Name of the tag.
+     * @param s Start index, should be index right after opening tag.
+     * @return Index of '<' char of closing tag, std::string::npos when not found.
      * @since 1.0.0
      */
-    //TODO create new function for processing tag and delivering result
-    void onTag() {
-        size_t tagEndIndex;
-        try {
-            tagEndIndex = stringUtils::indexOfOrThrow(content, ">", currentIndex);
-        } catch (std::runtime_error &e) {
-            platformUtils::log(
-                    "Unable to find char '>' in content from index: "
-                    + std::to_string(currentIndex) + ", content is not containing another tag",
-                    ANDROID_LOG_ERROR
-            );
-            clear();
-            return;
+    [[nodiscard]] size_t findWaitingRawTextEnd(
+            const StringView &tag,
+            size_t s
+    ) {
+        size_t closingTagStartIndex = findRawTextEnd(tag, std::max(s, rawTextResumeIndex));
+        if (closingTagStartIndex != std::string::npos) {
+            rawTextResumeIndex = closingTagStartIndex;
+        } else {
+            //'<' close to the end may start closing tag completed by next chunk
+            size_t candidateLength = tag.length() + 2;
+            rawTextResumeIndex = contentLength > candidateLength
+                                 ? std::max(s, contentLength - candidateLength)
+                                 : s;
         }
-        // -1 to remove '>' at the end
-        size_t tagBodyLength = tagEndIndex - currentIndex - 1;
-        //tag body within <>, currentIndex + 1 to remove '<'
-        std::string currentTagBody = content.substr(
-                currentIndex + 1,
-                tagBodyLength
-        );
-        std::string tag = htmlUtils::getTagName(currentTagBody);
-        bool isClosing = currentTagBody[0] == '/';
+        return closingTagStartIndex;
+    }
 
-        if (isFullHtmlDocument && !isHeadIterated) {
-            //Skipping head tag
-            //TODO maybe remove skipping head tag
-            if (stringUtils::equals(tag, "head")) {
-                isHeadIterated = true;
-                //index of < of closing tag
-                size_t closingTagStartIndex;
-                try {
-                    closingTagStartIndex = findClosingTag(
-                            tag,
-                            tagEndIndex + 1,
-                            contentLength,
-                            contentLength
-                    );
-                } catch (std::runtime_error &e) {
-                    //Html content can have syntax errors like unclosed pair tags or others,
-                    //so library should keep going, browsers are also ignoring these errors
-                    //Just keep parsing, just keep parsing
-                    currentIndex = tagEndIndex + 1;
-                    platformUtils::log("HtmlIterator", "Error: " + std::string(e.what()));
-                    return;
-                }
-                // + 1 + 1 is or "/>" at the end of closing tag
-                currentIndex = closingTagStartIndex + tag.length() + 1 + 1;
-                return;
-            }
+
+    /**
+     * Checks whatever opening and closing tag names are names of the same tag. Well known tags are
+     * compared by their ids, other tags by names ignoring case.
+     * @since 1.0.0
+     */
+    [[nodiscard]] static bool isSameTag(
+            const StringView &openingTag,
+            htmlNames::TagId openingTagId,
+            const StringView &closingTag,
+            htmlNames::TagId closingTagId
+    ) {
+        if (openingTagId != closingTagId) {
+            return false;
         }
+        return openingTagId != htmlNames::TagId::UNKNOWN
+               || htmlNames::equalsIgnoreCase(openingTag, closingTag);
+    }
 
 
-        if (isClosing && !tagStack.empty()) {
-            TagInfo lastTag = tagStack.top();
-            callback->onLeavingPairTag(lastTag);
+    /**
+     * Finds '>' char closing the tag starting at s. Quoted attribute values can contain '>' char,
+     * so quoted values are skipped using <code>structuralIndex</code>.
+     * @param s Index of '<' char of the tag.
+     * @return Index of '>' char closing the tag, std::string::npos when not found.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t findTagEnd(size_t s) const {
+        size_t tagEndIndex = structuralIndex.nextTagEnd(s);
+        size_t quoteIndex = structuralIndex.nextQuote(s);
+
+        while (tagEndIndex != std::string::npos && quoteIndex < tagEndIndex) {
+            if (!isAttributeValueStart(s, quoteIndex)) {
+                //Quote is just a char within the tag, e.g. in unquoted value
+                quoteIndex = structuralIndex.nextQuote(quoteIndex + 1);
+                continue;
+            }
 
-            trySendContentText(lastTag);
+            size_t closingQuoteIndex = structuralIndex.nextQuote(quoteIndex + 1);
+            while (closingQuoteIndex != std::string::npos
+                   && content[closingQuoteIndex] != content[quoteIndex]) {
+                closingQuoteIndex = structuralIndex.nextQuote(closingQuoteIndex + 1);
+            }
 
-            if (stringUtils::equals(tag, "/pre")) {
-                isPreContext = false;
+            if (closingQuoteIndex == std::string::npos) {
+                //Unclosed attribute value, streamed content may close it in next chunk, otherwise
+                //it's syntax error and first '>' is considered end of the tag
+                return isInputComplete ? tagEndIndex : std::string::npos;
             }
 
-            tagStack.pop();
-            currentIndex = tagEndIndex + 1;
-            return;
+            if (closingQuoteIndex > tagEndIndex) {
+                //'>' was inside the attribute value
+                tagEndIndex = structuralIndex.nextTagEnd(closingQuoteIndex + 1);
+            }
+            quoteIndex = structuralIndex.nextQuote(closingQuoteIndex + 1);
         }
+        return tagEndIndex;
+    }
 
-        //Extracts tag info from current tag body
-        TagInfo info = TagInfo(tag, currentTagBody);
-        trySendContentText(info);
 
-        if (info.isSingleTag()) {
-            callback->onSingleTag(info);
-        } else {
-            //TODO unit test
-            if (stringUtils::equals(tag, "pre")) {
-                isPreContext = true;
-            }
-
-            //closing tag start index
-            size_t closingTagStartIndex;
-            try {
-                closingTagStartIndex = findClosingTag(
-                        tag,
-                        tagEndIndex + 1,
-                        contentLength,
-                        contentLength
-                );
-            } catch (std::runtime_error &e) {
-                //Html content can have syntax errors like unclosed pair tags or others,
-                //so library should keep going, browsers are also ignoring these errors
-                //Just keep parsing, just keep parsing
-                currentIndex = tagEndIndex + 1;
-                platformUtils::log("HtmlIterator", "Error: " + std::string(e.what()));
-                return;
+    /**
+     * @param s Index of '<' char of the tag.
+     * @param quoteIndex Index of quote char within the tag.
+     * @return True when quote at quoteIndex starts quoted attribute value, so it's preceded by '='
+     * and optional white chars.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isAttributeValueStart(
+            size_t s,
+            size_t quoteIndex
+    ) const {
+        size_t i = quoteIndex;
+        while (i > s) {
+            i -= 1;
+            CharT ch = content[i];
+            if (!stringUtils::isWhiteChar(ch)) {
+                return ch == '=';
             }
+        }
+        return false;
+    }
 
-            //Closing tag end index
-            //+ 2 because of chars '/' and >;
-            size_t closingTagEndIndex = closingTagStartIndex + tag.length() + 2;
-
-            //TODO unit test
-            if (stringUtils::equals(tag, "script")) {
-                callback->onScript(info);
-                currentIndex = closingTagStartIndex + 1;
-                return;
-            } else {
-                info.setPairContent(
-                        tagEndIndex + 1,
-                        closingTagStartIndex
-                );
-
-                //Adding tag into stack after closing tag is found succesfully to manage consistency
-                //of the stack.
-                tagStack.push(info);
-                tagSequence.push(info);
-
-                bool stepInto = callback->onPairTag(
-                        info,
-                        currentIndex,
-                        tagEndIndex,
-                        closingTagStartIndex,
-                        closingTagEndIndex
-                );
 
-                if (stepInto) {
-                    currentIndex = tagEndIndex + 1;
-                } else {
-                    currentIndex = closingTagStartIndex + 1;
-                }
+    /**
+     * Finds end of comment, which is "-->" sequence, using <code>structuralIndex</code>.
+     * @param s Start index, index right after "<!--".
+     * @return Index of first '-' char of "-->", std::string::npos when comment is unclosed.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t findCommentEnd(size_t s) const {
+        size_t i = structuralIndex.nextTagEnd(s + 2);
+        while (i != std::string::npos) {
+            if (content[i - 1] == '-' && content[i - 2] == '-') {
+                return i - 2;
             }
-            return;
+            i = structuralIndex.nextTagEnd(i + 1);
         }
-
-
-        currentIndex = tagEndIndex + 1;
+        return std::string::npos;
     }
 
 
     /**
-     * Tries to append ch into sharedContent string if it's possible. Html content is full of white
-     * characters that needs to be processed correctly before being appended into visible content.
+     * Tries to append text between s and e into sharedContent string if it's possible. Html content
+     * is full of white characters that needs to be processed correctly before being appended into
+     * visible content. Text is processed by runs, every run of non white characters is appended at
+     * once with character references decoded, see <code>htmlEntities::appendDecoded</code>, and
+     * every run of white characters is collapsed at once.
      * <li>
      * <ul>
      * <b>Outside &lt;pre&gt; tag</b> - There can't be two white characters next to each other, so
-     * when char is white, it's compared to last appended char if it can be connected.
+     * run of white characters is collapsed into single space, unless last appended char is already
+     * space.
      * </ul>
      * <ul>
      * <b>Inside &lt;pre&gt; tag:</b> - All white chars is appended to sharedContent to be visible.
      * </ul>
-     * @param ch Char to be appended into sharedContent
+     * @param s Start index of the text within content, inclusive.
+     * @param e End index of the text within content, exclusive.
      * @since 1.0.0
      */
-    void tryAppendCharToContent(char ch) {
+    void tryAppendTextToContent(
+            size_t s,
+            size_t e
+    ) {
         if (isPreContext) {
             //Iterator is inside of <pre> tag somewhere, so every char (including all white chars)
             //has to be appended.
-            currentTextNode += ch;
+            htmlEntities::appendDecoded(currentTextNode, content.substr(s, e - s));
             return;
         }
+        appendCollapsedText(currentTextNode, s, e, stringUtils::endsWith(currentTextNode, ' '));
+    }
+
+
+    /**
+     * Appends text between s and e into out with every run of white characters collapsed into
+     * single space, see <code>tryAppendTextToContent</code>.
+     * @param out String to append the text to.
+     * @param s Start index of the text within content, inclusive.
+     * @param e End index of the text within content, exclusive.
+     * @param isAfterSpace True when out already ends with space, so leading white characters are
+     * dropped.
+     * @since 1.0.0
+     */
+    void appendCollapsedText(
+            String &out,
+            size_t s,
+            size_t e,
+            bool isAfterSpace
+    ) const {
+        size_t i = s;
+        while (i < e) {
+            size_t whiteCharIndex = stringUtils::nextWhiteChar(content, i, e);
+            if (whiteCharIndex == std::string::npos) {
+                whiteCharIndex = e;
+            }
+            if (whiteCharIndex > i) {
+                htmlEntities::appendDecoded(out, content.substr(i, whiteCharIndex - i));
+                isAfterSpace = false;
+            }
+
+            if (whiteCharIndex == e) {
+                return;
+            }
+
+            i = stringUtils::nextNonWhiteChar(content, whiteCharIndex, e);
+            if (i == std::string::npos) {
+                i = e;
+            }
+
+            //We are outside of <pre> tag, always one white char is enabled to be visible between
+            //other charters.
+            if (!isAfterSpace) {
+                out += ' ';
+                isAfterSpace = true;
+            }
+        }
+    }
 
-        bool isCharWhite = stringUtils::isWhiteChar(ch);
-        if (!isCharWhite) {
-            currentTextNode += ch;
-        } else {
-            if (!currentTextNode.empty()) {
-                //We are outside of <pre> tag, always one white char is enabled to be visible between
-                //other charters.
-                size_t lastIndex = currentTextNode.size() - 1;
-                if (currentTextNode[lastIndex] != ' ' && ch == ' ') {
-                    //currentTextNode's last char is not white, so we can append new char
-                    currentTextNode += ch;
+
+    /**
+     * Appends collapsed text of TEXT token into <code>currentTextNode</code>. Token text was
+     * collapsed without knowing <code>currentTextNode</code>, so its leading space is dropped when
+     * <code>currentTextNode</code> already ends with space, same as in
+     * <code>appendCollapsedText</code>.
+     * @since 1.0.0
+     */
+    void appendTokenText(const Token &token) {
+        StringView text = speculativeTokens.getText(token);
+        if (!text.empty() && text.front() == ' ' && stringUtils::endsWith(currentTextNode, ' ')) {
+            text.remove_prefix(1);
+        }
+        currentTextNode.append(text);
+    }
+
+
+    /**
+     * Lexes segment of the content into tokens the same way as iterator moves through the content,
+     * see <code>SpeculativeTokens</code>. Called in parallel for different segments, so it must
+     * not change state of the iterator.
+     * @param s Start index of the segment, segment is expected to start outside of any tag.
+     * @param e End index of the segment, lexing continues until the next token starts at e or
+     * after it.
+     * @param segment Segment to write tokens into.
+     * @since 1.0.0
+     */
+    void lexSegment(
+            size_t s,
+            size_t e,
+            Segment &segment
+    ) const {
+        size_t i = s;
+        while (i < e) {
+            size_t tagStartIndex = structuralIndex.nextTagStart(i);
+            size_t textEndIndex = tagStartIndex != std::string::npos ? tagStartIndex : contentLength;
+            if (textEndIndex > i) {
+                size_t textOffset = segment.text.length();
+                appendCollapsedText(segment.text, i, textEndIndex, false);
+                segment.tokens.push_back({
+                        i,
+                        textEndIndex,
+                        static_cast<uint32_t>(textOffset),
+                        static_cast<uint32_t>(segment.text.length() - textOffset),
+                        TokenType::TEXT
+                });
+            }
+            if (tagStartIndex == std::string::npos || tagStartIndex >= e) {
+                return;
+            }
+
+            i = tagStartIndex;
+            if (structuralIndex.isCommentStart(i)) {
+                size_t commentEndIndex = findCommentEnd(i + 4);
+                //Unclosed comment is skipped by its '<' only, same as in canProcessIncomingSequence
+                size_t end = commentEndIndex != std::string::npos ? commentEndIndex + 2 : i;
+                segment.tokens.push_back({i, end, 0, 0, TokenType::SKIPPED});
+                i = end + 1;
+                continue;
+            }
+            if (i + 12 < contentLength && stringUtils::equals(content.substr(i + 1, 12), "/![cdata[//>")) {
+                segment.tokens.push_back({i, i + 12, 0, 0, TokenType::SKIPPED});
+                i += 13;
+                continue;
+            }
+
+            size_t tagEndIndex = findTagEnd(i);
+            if (tagEndIndex == std::string::npos) {
+                return;
+            }
+            segment.tokens.push_back({i, tagEndIndex, 0, 0, TokenType::TAG});
+            i = tagEndIndex + 1;
+
+            StringView tagBody = content.substr(tagStartIndex + 1, tagEndIndex - tagStartIndex - 1);
+            StringView tag = htmlUtils::getTagName(tagBody);
+            if (htmlNames::getTagId(tag) == htmlNames::TagId::SCRIPT
+                && !stringUtils::endsWith(tagBody, '/')) {
+                //Content of script is never lexed by iterator, lexing continues behind it
+                size_t scriptEndIndex = findRawTextEnd(tag, i);
+                size_t closingTagEndIndex = scriptEndIndex != std::string::npos
+                                            ? structuralIndex.nextTagEnd(scriptEndIndex)
+                                            : std::string::npos;
+                if (closingTagEndIndex == std::string::npos) {
+                    return;
                 }
-            } else {
-                currentTextNode += ch;
+                i = closingTagEndIndex + 1;
             }
         }
     }
@@ -456,17 +1606,24 @@ private:
     /**
      *
      * @param tag Pair tag in which is currentTextNode located
+     * @param isTagLeft True when the tag was just left, text is delivered by onLeftPairTagText.
      */
     //TODO unit test on white chars and spaces handling
     void trySendContentText(
-            TagInfo &tag
+            TagInfo &tag,
+            bool isTagLeft
     ) {
         bool canBeSend = adjustSharedContentContextually(tag);
 
-        if (canBeSend) {
+        if (canBeSend && isExtractingText) {
+            textExtractor.appendText(currentTextNode, isPreContext);
+        } else if (canBeSend && isTagLeft) {
+            callback->onLeftPairTagText(currentTextNode, tag);
+        } else if (canBeSend) {
             callback->onContentText(currentTextNode);
-            //using emplace instead of push to get copy of currentTextNode string
-            textNodes.emplace(currentTextNode);
+        }
+        if (canBeSend) {
+            previousTextLastChar = currentTextNode.back();
         }
         currentTextNode.clear();
 
@@ -476,15 +1633,11 @@ private:
         if (tagStack.empty() && !isFullHtmlDocument) {
             //When sequence is empty text can be send only if content is not full document
             callback->onContentText(currentTextNode);
-            textNodes.emplace(currentTextNode);
             currentTextNode.clear();
             return;
         }
 
-        //Pushing first text into stack, no need to do check with last entry
         callback->onContentText(currentTextNode);
-        //using emplace instead of push to get copy of currentTextNode string
-        textNodes.emplace(currentTextNode);
 
         currentTextNode.clear();
          */
@@ -504,8 +1657,9 @@ private:
      * <br/>
      * <h4>Inside <code>&lt;pre&gt;</code> tag</h4>
      * If <code>currentTextNode</code> is somewhere within <code>&lt;pre&gt;</code> tag context, no
-     * adjustment is made as pre tag should preserve white spaces of the content. If there is no pre
-     * context, <code>currentTextNode</code> is then normalized.
+     * adjustment is made as pre tag should preserve white spaces of the content. Outside of pre
+     * context <code>currentTextNode</code> is already normalized, white chars were collapsed while
+     * the text was appended, see <code>appendCollapsedText</code>.
      * <hr/>
      * <br/>
      * <h4>Between container tags</h4>
@@ -540,14 +1694,15 @@ private:
             return true;
         }
 
-        //All white chars can be included only inside <pre> tag, otherwise text must be normalized
-        htmlUtils::normalizeText(currentTextNode);
-
-
-        if (tagSequence.empty() || textNodes.empty()) {
+        if (!isAnyPairTagFound || previousTextLastChar == 0) {
             //No tag was found before, also any text, we don't know how to adjust content so we
-            //just apply trim.
-            stringUtils::trim(currentTextNode);
+            //just apply trim. Extracted text keeps trailing space, it may separate the text from
+            //following inline tag which is not delivered as separate step there.
+            if (isExtractingText) {
+                stringUtils::ltrim(currentTextNode);
+            } else {
+                stringUtils::trim(currentTextNode);
+            }
 
             if (currentTextNode.empty()) {
                 return false;
@@ -556,13 +1711,10 @@ private:
         }
 
 
-        TagInfo previousTag = tagSequence.top();
-        bool isLastTagInline = htmlUtils::isInlineTag(previousTag.getTag());
-        bool isTagInline = htmlUtils::isInlineTag(tag.getTag());
+        bool isLastTagInline = isPreviousPairTagInline;
+        bool isTagInline = tag.hasFlag(htmlNames::TAG_FLAG_INLINE);
 
-        std::string previousText = textNodes.top();
-
-        if (!isTagInline || !isLastTagInline || stringUtils::endsWith(previousText, ' ')) {
+        if (!isTagInline || !isLastTagInline || previousTextLastChar == ' ') {
             if (stringUtils::startsWith(currentTextNode, ' ')) {
                 //We are outside of <pre> and tag is not inline, currentTextNode was normalized
                 // and can have only one space at the beginning
@@ -596,6 +1748,9 @@ private:
     [[nodiscard]] bool moveIndexToInitialPosition() {
         size_t firstI = stringUtils::nextNonWhiteChar(content, 0, contentLength);
         if (firstI == std::string::npos) {
+            if (waitForInput()) {
+                return false;
+            }
             //Content is "blank" (empty), containing only white chars
             this->currentIndex = contentLength;
             return false;
@@ -608,39 +1763,27 @@ private:
         this->currentIndex = firstI;
 
 
-        while (!moveIndexToNextTag() && currentIndex < contentLength) {
+        while (!moveIndexToNextTag() && currentIndex < contentLength && !isWaitingForInput) {
             //Waiting for move index to the first tag of content
         }
 
+        if (isWaitingForInput || ((currentIndex + 14) >= contentLength && waitForInput())) {
+            //Streamed content is too short to recognize the first tag yet
+            return false;
+        }
+
         //TODO better implementation
+        StringView contentView = content;
         if ((currentIndex + 4) < contentLength) {
-            std::string sub;
-            size_t il = currentIndex + 1 + 4;
-            try {
-                sub = content.substr(currentIndex + 1, 4);
-            } catch (std::out_of_range &e) {
-                return false;
-            }
-
-
+            StringView sub = contentView.substr(currentIndex + 1, 4);
             if (stringUtils::equals(sub, "html")) {
-                this->currentIndex = il;
-                return true;
+                return moveIndexBehindInitialTag(currentIndex + 1 + 4);
             }
         }
         if ((currentIndex + 14) < contentLength) {
-            std::string sub;
-            size_t il = currentIndex + 1 + 13;
-            try {
-                sub = content.substr(currentIndex + 1, 13);
-            } catch (std::out_of_range &e) {
-                return false;
-            }
-
-
-            if (stringUtils::equalsCaseInsensitive(sub, "!doctype html")) {
-                this->currentIndex = il;
-                return true;
+            StringView sub = contentView.substr(currentIndex + 1, 13);
+            if (htmlNames::equalsIgnoreCase(sub, std::string_view("!doctype html"))) {
+                return moveIndexBehindInitialTag(currentIndex + 1 + 13);
             }
         }
 
@@ -648,6 +1791,24 @@ private:
     }
 
 
+    /**
+     * Moves currentIndex behind '>' of &lt;html&gt; or doctype tag, so the rest of the tag is not
+     * taken as text.
+     * @param i Index right after the tag name.
+     * @return True when index was moved, false when streamed content has to wait for the end of the
+     * tag.
+     * @since 1.0.0
+     */
+    bool moveIndexBehindInitialTag(size_t i) {
+        size_t tagEndIndex = structuralIndex.nextTagEnd(i);
+        if (tagEndIndex == std::string::npos && waitForInput()) {
+            return false;
+        }
+        this->currentIndex = tagEndIndex != std::string::npos ? tagEndIndex + 1 : i;
+        return true;
+    }
+
+
     /**
      * Called from <code>moveIndexToNextTag</code> when index is pointing to < char and iterator needs to know if
      * string sequence after < is valid tag or not.
@@ -671,38 +1832,25 @@ private:
 
         size_t i = s;
         outIndex = i;
-        if ((i + 3) < l) {
-            std::string sub;
-            size_t il = i + 3;
-            try {
-                sub = content.substr(i + 1, 3);
-            } catch (std::out_of_range &e) {
+        if (i + 13 >= l && waitForInput()) {
+            //Not enough chars to recognize comment or cdata yet
+            return false;
+        }
+        if (structuralIndex.isCommentStart(i)) {
+            //In this case next sequence after < is comment,skipping at the end of comment
+            size_t ei = findCommentEnd(i + 4);
+            if (ei == std::string::npos) {
+                waitForInput();
                 return false;
             }
 
-            if (stringUtils::equals(sub, "!--")) {
-                //In this case next sequence after < is comment,skipping at the end of comment
-                size_t ei;
-                try {
-                    ei = stringUtils::indexOfOrThrow(content, "-->", il);
-                } catch (std::runtime_error &e) {
-                    return false;
-                }
-
-                outIndex = ei + 3;
-                return false;
-            }
+            //Index of the last char of the comment, the '>' char
+            outIndex = ei + 2;
+            return false;
         }
         if (i + 12 < l) {
-            std::string sub;
             size_t il = i + 12;
-            try {
-                sub = content.substr(i + 1, 12);
-            } catch (std::out_of_range &e) {
-                return false;
-            }
-
-            if (stringUtils::equals(sub, "/![cdata[//>")) {
+            if (stringUtils::equals(content.substr(i + 1, 12), "/![cdata[//>")) {
                 outIndex = il;
                 return false;
             }
@@ -724,36 +1872,47 @@ private:
     * searching for <p> must be in clipped content ..... </p>
     *
     * Note: There is no validation of pair tags inside, you are responsible for searching the proper
-    * pair tag.
+    * pair tag. Searched tag has to be the last one in <code>tagStack</code>, closing tag of any of
+    * its parents is considered closing tag of the searched tag too, same as in <code>onClosingTag</code>. This is lookahead through whole subtree of the tag, so it's used only for skipping
+    * content of the pair tag, pair tags are matched by <code>tagStack</code> otherwise.
     * @param input Input string in which closing tag will be searched
     * @param tag Lowercase pair tag name you are searching for
     * @param s Start index
     * @param e End index. Optional, if value is less than 0, input.length() will be used.
-    * @throw std::runtime_error When closing tag was not found within content
-    * @return Index if start of the closing tag, index of '<' char
+    * @param nestedTagsCount Count of opened nested tags of the same name, kept between calls when
+    * search is resumed with next chunk of streamed content.
+    * @param resumeIndex Set to index where the search can be resumed when closing tag was not found,
+    * index of incomplete sequence at the end of the content or e.
+    * @return Index if start of the closing tag, index of '<' char, std::string::npos when closing tag
+    * was not found within content
     * @since 1.0.0
     */
     [[nodiscard]] size_t findClosingTag(
-            std::string &searchedTag,
+            const StringView &searchedTag,
             size_t s,
             size_t e,
-            size_t length
+            size_t length,
+            size_t &nestedTagsCount,
+            size_t &resumeIndex
     ) {
         size_t i = s;
         size_t outI = i;
 
-        size_t tempWorkingNumber = 0;
-
         size_t end = e > 0 ? e : length;
+        resumeIndex = end;
+        htmlNames::TagId searchedTagId = htmlNames::getTagId(searchedTag);
         while (i < end) {
-            char ch = content[i];
-            if (ch != '<' && i < end) {
-                i += 1;
-                continue;
+            i = structuralIndex.nextTagStart(i);
+            if (i == std::string::npos || i >= end) {
+                break;
             }
 
             //char is '<'
             if (!canProcessIncomingSequence(length, i, outI)) {
+                if (isWaitingForInput) {
+                    resumeIndex = i;
+                    break;
+                }
                 //Unable to process
                 if (i == outI) {
                     i += 1;
@@ -764,40 +1923,50 @@ private:
             }
 
             //TagType closing index, index of next '>'
-            size_t tei = stringUtils::indexOfOrThrow(content, ">", i);
+            size_t tei = findTagEnd(i);
+            if (tei == std::string::npos) {
+                resumeIndex = i;
+                break;
+            }
             // -1 to remove '>' at the end
             size_t tagBodyLength = tei - i - 1;
             //tag body within <>, currentIndex + 1 to remove '<'
-            std::string tagBody = content.substr(i + 1, tagBodyLength);
-            std::string rawTagName = htmlUtils::getTagName(tagBody);
-            bool isClosingTag = rawTagName[0] == '/';
+            StringView tagBody = content.substr(i + 1, tagBodyLength);
+            StringView rawTagName = htmlUtils::getTagName(tagBody);
+            bool isClosingTag = stringUtils::startsWith(rawTagName, '/');
+            StringView tagName = isClosingTag ? rawTagName.substr(1) : rawTagName;
+            bool isSearchedTag = isSameTag(searchedTag, searchedTagId, tagName, htmlNames::getTagId(tagName));
 
             if (isClosingTag) {
-                std::string tagName = content.substr(i + 2, rawTagName.length() - 1);
-                if (stringUtils::equals(tagName, searchedTag)) {
-                    if (tempWorkingNumber > 0) {
+                if (isSearchedTag) {
+                    if (nestedTagsCount > 0) {
                         //Stack is not empty, means that we found closing of inner same tag
-                        tempWorkingNumber -= 1;
+                        nestedTagsCount -= 1;
                     } else {
                         return i;
                     }
+                } else if (isClosingParentTag(tagName)) {
+                    //Searched tag is unclosed, closing tag of its parent closes it too
+                    return i;
                 }
             } else {
-                if (stringUtils::equals(searchedTag, rawTagName)) {
+                if (isSearchedTag) {
                     //Push because inside tag is another one, like p in p -> <p><p>...</p></p>
-                    tempWorkingNumber += 1;
+                    nestedTagsCount += 1;
                 }
             }
             i = tei + 1;
         }
 
-        throw std::runtime_error(
-                "Unable to find closing tag for: " + std::string(searchedTag)
-        );
+        return std::string::npos;
     }
 
 
 };
 
 
+using HtmlIterator = BasicHtmlIterator<char>;
+using HtmlIterator16 = BasicHtmlIterator<char16_t>;
+
+
 #endif //ANDROID_HTML_ITERATOR_HTMLITERATOR_H
\ No newline at end of file
@@ -11,18 +11,25 @@
 /**
  * Callback interface for HtmlIterator to deliver results. Can be implemented directly in c++ or
  * in java using JniHtmlIteratorCallback to deliver results into kotlin HtmlIterator#Callback.
+ * CharT is type of code units of the content, see BasicHtmlIterator.
  * @since 1.0.0
  */
-class HtmlIteratorCallback {
+template<typename CharT>
+class BasicHtmlIteratorCallback {
 
 public:
+    using TagInfo = BasicTagInfo<CharT>;
+
+
+    virtual ~BasicHtmlIteratorCallback() = default;
+
 
     /**
      * Called from HtmlIterator when plain text is found.
      * @param text
      * @since 1.0.0
      */
-    virtual void onContentText(std::string &text) = 0;
+    virtual void onContentText(std::basic_string<CharT> &text) = 0;
 
 
     /**
@@ -43,24 +50,60 @@ public:
     /**
      * Called from HtmlIterator when pair tag is found.
      * @param tag
+     * @param openingTagStartIndex Index of '<' char of opening tag.
+     * @param openingTagEndIndex Index of '>' char of opening tag.
+     * @param closingTagStartIndex Index of '<' char of closing tag. Known only when closing tag index
+     * is enabled by HtmlIterator::setClosingTagIndexEnabled() and tag is closed, UINT64_MAX
+     * otherwise.
+     * @param closingTagEndIndex Index of '>' char of closing tag, same rules as for
+     * closingTagStartIndex.
      * @return True when iterator should iterate through content of pair tag, false otherwise, allowing
      * to add some custom filtering logic.
      * @since 1.0.0
      */
     virtual bool onPairTag(
             TagInfo &tag,
-            size_t openingTagStartIndex,
-            size_t openingTagEndIndex,
-            size_t closingTagStartIndex,
-            size_t closingTagEndIndex
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
     ) = 0;
 
 
     /**
      * Called from HtmlIterator when leaving pair tag.
+     * @param tag
+     * @param closingTagStartIndex Index of '<' char of closing tag. When tag was never closed, it's
+     * index of closing tag of its parent or length of the content.
+     * @param closingTagEndIndex Index of '>' char of closing tag, same rules as for
+     * closingTagStartIndex.
+     * @since 1.0.0
      */
-    virtual void onLeavingPairTag(TagInfo &tag) = 0;
+    virtual void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) = 0;
+
+
+    /**
+     * Called from HtmlIterator instead of onContentText for text at the end of pair tag, the text is
+     * delivered right after onLeavingPairTag of the tag. Delivers the text by onContentText by
+     * default, override when owner of the text matters.
+     * @param text
+     * @param tag Pair tag which was left and which contains the text.
+     * @since 1.0.0
+     */
+    virtual void onLeftPairTagText(
+            std::basic_string<CharT> &text,
+            TagInfo &tag
+    ) {
+        onContentText(text);
+    }
 
 };
 
+
+using HtmlIteratorCallback = BasicHtmlIteratorCallback<char>;
+
 #endif //ANDROID_HTML_ITERATOR_HTMLITERATORCALLBACK_H
\ No newline at end of file
@@ -0,0 +1,523 @@
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#ifndef ANDROID_HTML_ITERATOR_HTMLNAMES_H
+#define ANDROID_HTML_ITERATOR_HTMLNAMES_H
+
+
+/**
+ * Classification of well known tag and attribute names. Names are mapped to ids by perfect hash
+ * tables generated at compile time, so classification of a name costs one hash and one table
+ * lookup. Names are matched case insensitively, as html does.
+ * @since 1.0.0
+ */
+namespace htmlNames {
+
+
+    /**
+     * Id of well known tag, value is index into <code>tagDefinitions</code>.
+     * @since 1.0.0
+     */
+    enum class TagId : uint8_t {
+        UNKNOWN = 0,
+        A, ABBR, ACRONYM, ADDRESS, APPLET, AREA, ARTICLE, ASIDE, AUDIO,
+        B, BASE, BASEFONT, BDI, BDO, BIG, BLOCKQUOTE, BODY, BR, BUTTON,
+        CANVAS, CAPTION, CENTER, CITE, CODE, COL, COLGROUP,
+        DATA, DATALIST, DD, DEL, DETAILS, DFN, DIALOG, DIR, DIV, DL, DT,
+        EM, EMBED,
+        FIELDSET, FIGCAPTION, FIGURE, FONT, FOOTER, FORM, FRAME, FRAMESET,
+        H1, H2, H3, H4, H5, H6, HEAD, HEADER, HGROUP, HR, HTML,
+        I, IFRAME, IMG, INPUT, INS,
+        KBD, KEYGEN,
+        LABEL, LEGEND, LI, LINK,
+        MAIN, MAP, MARK, MARQUEE, MATH, MENU, META, METER,
+        NAV, NOBR, NOEMBED, NOFRAMES, NOSCRIPT,
+        OBJECT, OL, OPTGROUP, OPTION, OUTPUT,
+        P, PARAM, PICTURE, PLAINTEXT, PRE, PROGRESS,
+        Q,
+        RP, RT, RUBY,
+        S, SAMP, SCRIPT, SEARCH, SECTION, SELECT, SLOT, SMALL, SOURCE, SPAN, STRIKE, STRONG,
+        STYLE, SUB, SUMMARY, SUP, SVG,
+        TABLE, TBODY, TD, TEMPLATE, TEXTAREA, TFOOT, TH, THEAD, TIME, TITLE, TR, TRACK, TT,
+        U, UL,
+        VAR, VIDEO,
+        WBR,
+        XMP,
+    };
+
+
+    /**
+     * Flags of well known tags.
+     * @since 1.0.0
+     */
+    enum TagFlag : uint8_t {
+
+        /**
+         * Void element, it's single tag without closing tag, e.g. &lt;img&gt;.
+         */
+        TAG_FLAG_VOID = 1 << 0,
+
+        /**
+         * Inline text style element, e.g. &lt;b&gt;. White spaces between inline tags are kept.
+         */
+        TAG_FLAG_INLINE = 1 << 1,
+
+        /**
+         * Element with raw text content, content can't contain any tags, e.g. &lt;script&gt;.
+         */
+        TAG_FLAG_RAW_TEXT = 1 << 2,
+
+        /**
+         * Element belonging to document head, e.g. &lt;meta&gt;.
+         */
+        TAG_FLAG_HEAD = 1 << 3,
+    };
+
+
+    /**
+     * Id of well known attribute, value is index into <code>attributeNames</code>.
+     * @since 1.0.0
+     */
+    enum class AttributeId : uint8_t {
+        UNKNOWN = 0,
+        ACTION, ALIGN, ALT, AUTOPLAY, CHARSET, CHECKED, CITE, CLASS, COLSPAN, CONTENT, CONTROLS,
+        DATETIME, DIR, DISABLED, DOWNLOAD, FOR, HEIGHT, HIDDEN, HREF, HREFLANG, HTTP_EQUIV, ID,
+        LANG, LOADING, LOOP, MEDIA, METHOD, MUTED, NAME, PLACEHOLDER, POSTER, REL, ROLE, ROWSPAN,
+        SELECTED, SIZES, SRC, SRCSET, STYLE, TABINDEX, TARGET, TITLE, TYPE, VALUE, WIDTH,
+    };
+
+
+    /**
+     * Definition of well known tag.
+     * @since 1.0.0
+     */
+    struct TagDefinition {
+        std::string_view name;
+        TagId id;
+        uint8_t flags;
+    };
+
+
+    /**
+     * Definitions of well known tags, ordered same as <code>TagId</code>.
+     * @since 1.0.0
+     */
+    inline constexpr TagDefinition tagDefinitions[] = {
+            {"",           TagId::UNKNOWN,    0},
+            {"a",          TagId::A,          TAG_FLAG_INLINE},
+            {"abbr",       TagId::ABBR,       0},
+            {"acronym",    TagId::ACRONYM,    0},
+            {"address",    TagId::ADDRESS,    0},
+            {"applet",     TagId::APPLET,     0},
+            {"area",       TagId::AREA,       TAG_FLAG_VOID},
+            {"article",    TagId::ARTICLE,    0},
+            {"aside",      TagId::ASIDE,      0},
+            {"audio",      TagId::AUDIO,      0},
+            {"b",          TagId::B,          TAG_FLAG_INLINE},
+            {"base",       TagId::BASE,       TAG_FLAG_VOID | TAG_FLAG_HEAD},
+            {"basefont",   TagId::BASEFONT,   TAG_FLAG_VOID},
+            {"bdi",        TagId::BDI,        0},
+            {"bdo",        TagId::BDO,        0},
+            {"big",        TagId::BIG,        0},
+            {"blockquote", TagId::BLOCKQUOTE, 0},
+            {"body",       TagId::BODY,       0},
+            {"br",         TagId::BR,         TAG_FLAG_VOID},
+            {"button",     TagId::BUTTON,     0},
+            {"canvas",     TagId::CANVAS,     0},
+            {"caption",    TagId::CAPTION,    0},
+            {"center",     TagId::CENTER,     0},
+            {"cite",       TagId::CITE,       0},
+            {"code",       TagId::CODE,       0},
+            {"col",        TagId::COL,        TAG_FLAG_VOID},
+            {"colgroup",   TagId::COLGROUP,   0},
+            {"data",       TagId::DATA,       0},
+            {"datalist",   TagId::DATALIST,   0},
+            {"dd",         TagId::DD,         0},
+            {"del",        TagId::DEL,        TAG_FLAG_INLINE},
+            {"details",    TagId::DETAILS,    0},
+            {"dfn",        TagId::DFN,        0},
+            {"dialog",     TagId::DIALOG,     0},
+            {"dir",        TagId::DIR,        0},
+            {"div",        TagId::DIV,        0},
+            {"dl",         TagId::DL,         0},
+            {"dt",         TagId::DT,         0},
+            {"em",         TagId::EM,         TAG_FLAG_INLINE},
+            {"embed",      TagId::EMBED,      TAG_FLAG_VOID},
+            {"fieldset",   TagId::FIELDSET,   0},
+            {"figcaption", TagId::FIGCAPTION, 0},
+            {"figure",     TagId::FIGURE,     0},
+            {"font",       TagId::FONT,       0},
+            {"footer",     TagId::FOOTER,     0},
+            {"form",       TagId::FORM,       0},
+            {"frame",      TagId::FRAME,      TAG_FLAG_VOID},
+            {"frameset",   TagId::FRAMESET,   0},
+            {"h1",         TagId::H1,         0},
+            {"h2",         TagId::H2,         0},
+            {"h3",         TagId::H3,         0},
+            {"h4",         TagId::H4,         0},
+            {"h5",         TagId::H5,         0},
+            {"h6",         TagId::H6,         0},
+            {"head",       TagId::HEAD,       TAG_FLAG_HEAD},
+            {"header",     TagId::HEADER,     0},
+            {"hgroup",     TagId::HGROUP,     0},
+            {"hr",         TagId::HR,         TAG_FLAG_VOID},
+            {"html",       TagId::HTML,       0},
+            {"i",          TagId::I,          TAG_FLAG_INLINE},
+            {"iframe",     TagId::IFRAME,     0},
+            {"img",        TagId::IMG,        TAG_FLAG_VOID},
+            {"input",      TagId::INPUT,      TAG_FLAG_VOID},
+            {"ins",        TagId::INS,        TAG_FLAG_INLINE},
+            {"kbd",        TagId::KBD,        0},
+            {"keygen",     TagId::KEYGEN,     TAG_FLAG_VOID},
+            {"label",      TagId::LABEL,      0},
+            {"legend",     TagId::LEGEND,     0},
+            {"li",         TagId::LI,         0},
+            {"link",       TagId::LINK,       TAG_FLAG_VOID | TAG_FLAG_HEAD},
+            {"main",       TagId::MAIN,       0},
+            {"map",        TagId::MAP,        0},
+            {"mark",       TagId::MARK,       TAG_FLAG_INLINE},
+            {"marquee",    TagId::MARQUEE,    0},
+            {"math",       TagId::MATH,       0},
+            {"menu",       TagId::MENU,       0},
+            {"meta",       TagId::META,       TAG_FLAG_VOID | TAG_FLAG_HEAD},
+            {"meter",      TagId::METER,      0},
+            {"nav",        TagId::NAV,        0},
+            {"nobr",       TagId::NOBR,       0},
+            {"noembed",    TagId::NOEMBED,    0},
+            {"noframes",   TagId::NOFRAMES,   0},
+            {"noscript",   TagId::NOSCRIPT,   0},
+            {"object",     TagId::OBJECT,     0},
+            {"ol",         TagId::OL,         0},
+            {"optgroup",   TagId::OPTGROUP,   0},
+            {"option",     TagId::OPTION,     0},
+            {"output",     TagId::OUTPUT,     0},
+            {"p",          TagId::P,          0},
+            {"param",      TagId::PARAM,      TAG_FLAG_VOID},
+            {"picture",    TagId::PICTURE,    0},
+            {"plaintext",  TagId::PLAINTEXT,  0},
+            {"pre",        TagId::PRE,        0},
+            {"progress",   TagId::PROGRESS,   0},
+            {"q",          TagId::Q,          0},
+            {"rp",         TagId::RP,         0},
+            {"rt",         TagId::RT,         0},
+            {"ruby",       TagId::RUBY,       0},
+            {"s",          TagId::S,          0},
+            {"samp",       TagId::SAMP,       0},
+            {"script",     TagId::SCRIPT,     TAG_FLAG_RAW_TEXT},
+            {"search",     TagId::SEARCH,     0},
+            {"section",    TagId::SECTION,    0},
+            {"select",     TagId::SELECT,     0},
+            {"slot",       TagId::SLOT,       0},
+            {"small",      TagId::SMALL,      TAG_FLAG_INLINE},
+            {"source",     TagId::SOURCE,     TAG_FLAG_VOID},
+            {"span",       TagId::SPAN,       TAG_FLAG_INLINE},
+            {"strike",     TagId::STRIKE,     0},
+            {"strong",     TagId::STRONG,     TAG_FLAG_INLINE},
+            {"style",      TagId::STYLE,      TAG_FLAG_RAW_TEXT | TAG_FLAG_HEAD},
+            {"sub",        TagId::SUB,        TAG_FLAG_INLINE},
+            {"summary",    TagId::SUMMARY,    0},
+            {"sup",        TagId::SUP,        TAG_FLAG_INLINE},
+            {"svg",        TagId::SVG,        0},
+            {"table",      TagId::TABLE,      0},
+            {"tbody",      TagId::TBODY,      0},
+            {"td",         TagId::TD,         0},
+            {"template",   TagId::TEMPLATE,   0},
+            {"textarea",   TagId::TEXTAREA,   0},
+            {"tfoot",      TagId::TFOOT,      0},
+            {"th",         TagId::TH,         0},
+            {"thead",      TagId::THEAD,      0},
+            {"time",       TagId::TIME,       0},
+            {"title",      TagId::TITLE,      TAG_FLAG_HEAD},
+            {"tr",         TagId::TR,         0},
+            {"track",      TagId::TRACK,      TAG_FLAG_VOID},
+            {"tt",         TagId::TT,         0},
+            {"u",          TagId::U,          TAG_FLAG_INLINE},
+            {"ul",         TagId::UL,         0},
+            {"var",        TagId::VAR,        0},
+            {"video",      TagId::VIDEO,      0},
+            {"wbr",        TagId::WBR,        TAG_FLAG_VOID},
+            {"xmp",        TagId::XMP,        0},
+    };
+
+
+    /**
+     * Names of well known attributes, ordered same as <code>AttributeId</code>.
+     * @since 1.0.0
+     */
+    inline constexpr std::string_view attributeNames[] = {
+            "",
+            "action", "align", "alt", "autoplay", "charset", "checked", "cite", "class", "colspan",
+            "content", "controls", "datetime", "dir", "disabled", "download", "for", "height",
+            "hidden", "href", "hreflang", "http-equiv", "id", "lang", "loading", "loop", "media",
+            "method", "muted", "name", "placeholder", "poster", "rel", "role", "rowspan",
+            "selected", "sizes", "src", "srcset", "style", "tabindex", "target", "title", "type",
+            "value", "width",
+    };
+
+
+    inline constexpr size_t tagsCount = sizeof(tagDefinitions) / sizeof(TagDefinition);
+    inline constexpr size_t attributesCount = sizeof(attributeNames) / sizeof(std::string_view);
+
+
+    /**
+     * @param ch Code unit of any type.
+     * @return Lowercase of ASCII letter as unsigned value, other code units are returned unchanged,
+     * so UTF-8 bytes and UTF-16 units out of ASCII range never match ASCII names.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    constexpr uint32_t toLowerAscii(CharT ch) {
+        auto unit = static_cast<uint32_t>(static_cast<std::make_unsigned_t<CharT>>(ch));
+        return (unit >= 'A' && unit <= 'Z') ? unit + ('a' - 'A') : unit;
+    }
+
+
+    /**
+     * Case insensitive FNV-1a hash with seed.
+     * @param name Name to be hashed, code units of any type.
+     * @param seed Seed of the hash.
+     * @return Hash of the name.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    constexpr uint32_t hash(
+            std::basic_string_view<CharT> name,
+            uint32_t seed
+    ) {
+        uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (CharT ch: name) {
+            h ^= static_cast<uint8_t>(toLowerAscii(ch));
+            h *= 16777619u;
+        }
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        return h;
+    }
+
+
+    /**
+     * @return True when a and b are same ignoring case of ASCII letters.
+     * @since 1.0.0
+     */
+    template<typename CharA, typename CharB>
+    constexpr bool equalsIgnoreCase(
+            std::basic_string_view<CharA> a,
+            std::basic_string_view<CharB> b
+    ) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (toLowerAscii(a[i]) != toLowerAscii(b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    /**
+     * Perfect hash table built by hash and displace (CHD) algorithm at compile time. Keys are
+     * hashed into buckets first, then every bucket, starting with the biggest one, gets
+     * displacement seed which maps all its keys into free slots of the table.
+     * @param KeysCount Count of the keys, key with index 0 is reserved for unknown name.
+     * @param BucketsCount Count of buckets for the first level hash.
+     * @param TableSize Size of the table, must be bigger than KeysCount.
+     * @since 1.0.0
+     */
+    template<size_t KeysCount, size_t BucketsCount, size_t TableSize>
+    struct PerfectHashTable {
+
+        /**
+         * Displacement seed of every bucket.
+         */
+        std::array<uint16_t, BucketsCount> displacements{};
+
+        /**
+         * Index of key for every slot, 0 for empty slot.
+         */
+        std::array<uint16_t, TableSize> slots{};
+
+        /**
+         * True when displacement was found for every bucket.
+         */
+        bool isBuilt = false;
+
+
+        template<typename GetKey>
+        constexpr explicit PerfectHashTable(GetKey getKey) {
+            std::array<uint16_t, KeysCount> bucketOfKey{};
+            std::array<uint16_t, BucketsCount> bucketSizes{};
+            std::array<uint16_t, BucketsCount> order{};
+
+            for (size_t k = 1; k < KeysCount; k++) {
+                bucketOfKey[k] = static_cast<uint16_t>(hash(getKey(k), 0) % BucketsCount);
+                bucketSizes[bucketOfKey[k]] += 1;
+            }
+
+            //Biggest buckets first, they are the hardest to place
+            for (size_t b = 0; b < BucketsCount; b++) {
+                order[b] = static_cast<uint16_t>(b);
+            }
+            for (size_t i = 1; i < BucketsCount; i++) {
+                uint16_t bucket = order[i];
+                size_t j = i;
+                while (j > 0 && bucketSizes[order[j - 1]] < bucketSizes[bucket]) {
+                    order[j] = order[j - 1];
+                    j -= 1;
+                }
+                order[j] = bucket;
+            }
+
+            for (size_t i = 0; i < BucketsCount; i++) {
+                uint16_t bucket = order[i];
+                if (bucketSizes[bucket] == 0) {
+                    break;
+                }
+
+                bool isPlaced = false;
+                for (uint32_t seed = 1; seed < 0xFFFF && !isPlaced; seed++) {
+                    std::array<uint16_t, KeysCount> candidateSlots{};
+                    size_t candidatesCount = 0;
+                    bool isFree = true;
+
+                    for (size_t k = 1; k < KeysCount && isFree; k++) {
+                        if (bucketOfKey[k] != bucket) {
+                            continue;
+                        }
+                        auto slot = static_cast<uint16_t>(hash(getKey(k), seed) % TableSize);
+                        if (slots[slot] != 0) {
+                            isFree = false;
+                        }
+                        for (size_t c = 0; c < candidatesCount && isFree; c++) {
+                            isFree = candidateSlots[c] != slot;
+                        }
+                        candidateSlots[candidatesCount] = slot;
+                        candidatesCount += 1;
+                    }
+
+                    if (!isFree) {
+                        continue;
+                    }
+
+                    size_t c = 0;
+                    for (size_t k = 1; k < KeysCount; k++) {
+                        if (bucketOfKey[k] == bucket) {
+                            slots[candidateSlots[c]] = static_cast<uint16_t>(k);
+                            c += 1;
+                        }
+                    }
+                    displacements[bucket] = static_cast<uint16_t>(seed);
+                    isPlaced = true;
+                }
+
+                if (!isPlaced) {
+                    return;
+                }
+            }
+            isBuilt = true;
+        }
+
+
+        /**
+         * @param name Name to be found.
+         * @return Index of key which may be equal to name, caller must compare the key with name.
+         * 0 when name is surely not a key.
+         */
+        template<typename CharT>
+        [[nodiscard]] constexpr size_t find(std::basic_string_view<CharT> name) const {
+            uint16_t seed = displacements[hash(name, 0) % BucketsCount];
+            if (seed == 0) {
+                return 0;
+            }
+            return slots[hash(name, seed) % TableSize];
+        }
+    };
+
+
+    inline constexpr PerfectHashTable<tagsCount, 64, 256> tagsTable(
+            [](size_t k) { return tagDefinitions[k].name; }
+    );
+    static_assert(tagsTable.isBuilt, "Unable to build perfect hash table for tags");
+
+
+    inline constexpr PerfectHashTable<attributesCount, 32, 128> attributesTable(
+            [](size_t k) { return attributeNames[k]; }
+    );
+    static_assert(attributesTable.isBuilt, "Unable to build perfect hash table for attributes");
+
+
+    /**
+     * @param name Name of the tag without '<', '/' and '>'.
+     * @return Definition of the tag, definition of TagId::UNKNOWN when tag is not well known.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    constexpr const TagDefinition &getTagDefinition(std::basic_string_view<CharT> name) {
+        size_t index = tagsTable.find(name);
+        if (index != 0 && equalsIgnoreCase(tagDefinitions[index].name, name)) {
+            return tagDefinitions[index];
+        }
+        return tagDefinitions[0];
+    }
+
+
+    /**
+     * @param name Name of the tag without '<', '/' and '>'.
+     * @return Id of the tag, TagId::UNKNOWN when tag is not well known.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    constexpr TagId getTagId(std::basic_string_view<CharT> name) {
+        return getTagDefinition(name).id;
+    }
+
+
+    constexpr TagId getTagId(std::string_view name) {
+        return getTagDefinition(name).id;
+    }
+
+
+    /**
+     * @param id Id of the tag.
+     * @return Flags of the tag, see <code>TagFlag</code>.
+     * @since 1.0.0
+     */
+    constexpr uint8_t getTagFlags(TagId id) {
+        return tagDefinitions[static_cast<size_t>(id)].flags;
+    }
+
+
+    /**
+     * @param name Name of the attribute.
+     * @return Id of the attribute, AttributeId::UNKNOWN when attribute is not well known.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    constexpr AttributeId getAttributeId(std::basic_string_view<CharT> name) {
+        size_t index = attributesTable.find(name);
+        if (index != 0 && equalsIgnoreCase(attributeNames[index], name)) {
+            return static_cast<AttributeId>(index);
+        }
+        return AttributeId::UNKNOWN;
+    }
+
+
+    constexpr AttributeId getAttributeId(std::string_view name) {
+        return getAttributeId<char>(name);
+    }
+
+
+    static_assert(getTagId("div") == TagId::DIV, "Tags table is broken");
+    static_assert(getTagId("XMP") == TagId::XMP, "Tags table is broken");
+    static_assert(getTagId("divx") == TagId::UNKNOWN, "Tags table is broken");
+    static_assert(getAttributeId("Class") == AttributeId::CLASS, "Attributes table is broken");
+    static_assert(getAttributeId("width") == AttributeId::WIDTH, "Attributes table is broken");
+    static_assert(getTagId(std::u16string_view(u"Div")) == TagId::DIV, "Tags table is broken");
+    static_assert(getTagId(std::u16string_view(u"d\u0169v")) == TagId::UNKNOWN, "Tags table is broken");
+}
+
+#endif //ANDROID_HTML_ITERATOR_HTMLNAMES_H
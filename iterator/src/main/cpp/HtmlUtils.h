@@ -4,12 +4,11 @@
 
 #include <string>
 #include <map>
-#include <iterator>
-#include <set>
 #include <cctype>
 #include <algorithm>
 #include "StringUtils.h"
 #include "PlatformUtils.h"
+#include "HtmlNames.h"
 
 #ifndef ANDROID_HTML_ITERATOR_HTMLUTILS_H
 #define ANDROID_HTML_ITERATOR_HTMLUTILS_H
@@ -17,66 +16,21 @@
 namespace htmlUtils {
 
 
-    /**
-     * List of standard single tags.
-     * @since 1.0.0
-     */
-    std::set<std::string_view> singleTags = {
-            "img",
-            "input",
-            "br",
-            "hr",
-            "meta",
-            "link",
-            "area",
-            "base",
-            "col",
-            "source",
-            "track",
-            "wbr"
-    };
-
-
-    /**
- * @since 1.0.0
- */
-    const std::set<std::string_view> textStyleTags = {
-            "span",
-            "a",
-            "b",
-            "i",
-            "u",
-            "strong",
-            "em",
-            "mark",
-            "small",
-            "del",
-            "ins",
-            "sub",
-            "sup",
-    };
-
-    auto singleTagsIteratorBegin = singleTags.begin();
-    auto singleTagsIteratorEnd = singleTags.end();
-
-
     /**
      * Extracts all attributes from tagBody and writes it into outMap. When tag attribute has no value,
-     * attribute value is set to empty string.
+     * attribute value is set to empty string. Keys and values are views into tagBody, so tagBody
+     * has to outlive outMap.
      * @param tagBody Body of tag inside brackets without brackets '<' body '>'.
      * @param outMap Mutable map for holding extracted attributes.
      * @since 1.0.0
      */
+    template<typename CharT, typename Map>
     void getTagAttributes(
-            const std::string &tagBody,
-            std::map<std::string, std::string> &outMap
+            const std::basic_string_view<CharT> &tagBody,
+            Map &outMap
     ) {
         size_t length = tagBody.length();
-        size_t i = 0;
-        size_t lastIndexBeforeWhiteChar = 0;
-        char ch;
-
-        i = stringUtils::nextWhiteChar(tagBody, i, length);
+        size_t i = stringUtils::nextWhiteChar(tagBody, 0, length);
 
         if (i == std::string::npos) {
             //There are not any attributes in tag
@@ -84,122 +38,113 @@ namespace htmlUtils {
         }
 
         while (i < length) {
-            ch = tagBody[i];
-            auto isWhiteChar = stringUtils::isWhiteChar(ch);
-
-            while (isWhiteChar && i < length) {
-                i += 1;
-                ch = tagBody[i];
-                isWhiteChar = stringUtils::isWhiteChar(ch);
-            }
-
-            // int ni = stringUtils::indexOf(tagBody, " ", i);
-            if (i >= length) {
+            i = stringUtils::nextNonWhiteChar(tagBody, i, length);
+            if (i == std::string::npos) {
                 //Tag has no attributes defined within it's body or we read all attributes already
                 return;
             }
-            size_t attributeNameStartIndex = i;
-            bool isEqualSignRequired = false;
-
-            while ((ch != '=') && i < length) {
-                if (!isWhiteChar) {
-                    if (isEqualSignRequired) {
-                        //Attribute has no value
-                        break;
-                    }
-                    lastIndexBeforeWhiteChar = i;
-                }
 
-                if (isWhiteChar && !isEqualSignRequired) {
-                    //Character is white, end of attribute name
-                    isEqualSignRequired = true;
-                }
-
-                ch = tagBody[++i];
-                isWhiteChar = stringUtils::isWhiteChar(ch);
+            if (tagBody[i] == '/') {
+                //Slash of self closing tag <tag />
+                i += 1;
+                continue;
             }
 
-            bool isEqualSign = ch == '=';
-
-            size_t attributeNameEndIndex = lastIndexBeforeWhiteChar;
-            std::string attributeName = tagBody.substr(
+            size_t attributeNameStartIndex = i;
+            while (i < length && tagBody[i] != '=' && tagBody[i] != '/'
+                   && !stringUtils::isWhiteChar(tagBody[i])) {
+                i += 1;
+            }
+            std::basic_string_view<CharT> attributeName = tagBody.substr(
                     attributeNameStartIndex,
-                    attributeNameEndIndex -
-                    attributeNameStartIndex + 1
+                    i - attributeNameStartIndex
             );
 
-            if (isEqualSignRequired && !isEqualSign) {
+            size_t equalSignIndex = stringUtils::nextNonWhiteChar(tagBody, i, length);
+            if (equalSignIndex == std::string::npos || tagBody[equalSignIndex] != '=') {
                 //In this case, attribute has no value
-                outMap[attributeName] = "";
-                i += 1;
+                outMap.emplace(attributeName, std::basic_string_view<CharT>());
                 continue;
-            } else {
-                //Attribute has value
+            }
 
-                //i + 1 because tagBody[i] == '='
-                size_t attributeValueStartIndex = i + 1;
-                size_t nextNonWhiteCharIndex = stringUtils::nextNonWhiteChar(
+            //Attribute has value
+            size_t attributeValueStartIndex = stringUtils::nextNonWhiteChar(
+                    tagBody,
+                    equalSignIndex + 1,
+                    length
+            );
+            if (attributeValueStartIndex == std::string::npos) {
+                outMap.emplace(attributeName, std::basic_string_view<CharT>());
+                return;
+            }
+
+            CharT valueContainerChar = tagBody[attributeValueStartIndex];
+            std::basic_string_view<CharT> attributeValue;
+            if (valueContainerChar == '"' || valueContainerChar == '\'') {
+                size_t attributeValueEndIndex = stringUtils::indexOf(
                         tagBody,
-                        attributeValueStartIndex,
-                        length
+                        valueContainerChar,
+                        attributeValueStartIndex + 1
                 );
-
-                char nextNonWhiteChar = tagBody[nextNonWhiteCharIndex];
-                size_t attributeValueEndIndex;
-                if (nextNonWhiteChar == '"') {
-                    attributeValueEndIndex = stringUtils::indexOf(
-                            tagBody,
-                            '"',
-                            attributeValueStartIndex + 1
-                    );
-
-                } else if (nextNonWhiteChar == '\'') {
-                    attributeValueEndIndex = stringUtils::indexOf(
-                            tagBody,
-                            '\'',
-                            attributeValueStartIndex + 1
-                    );
-                } else {
-                    //Closing double quote or apostrophe not found, probably error in syntax, continue
-                    i += 1;
-                    continue;
+                if (attributeValueEndIndex == std::string::npos) {
+                    //Closing double quote or apostrophe not found, probably error in syntax, rest
+                    //of the body is considered to be value
+                    attributeValueEndIndex = length;
                 }
 
                 //Plus 1 and minus 1 to remove " or ' from attribute value edges "value" -> value
-                std::string attributeValue = tagBody.substr(
+                attributeValue = tagBody.substr(
                         attributeValueStartIndex + 1,
                         attributeValueEndIndex - attributeValueStartIndex - 1
                 );
-
-                //TODO minimaze usage of trim
-                stringUtils::trim(attributeName);
-                stringUtils::trim(attributeValue);
-                outMap[attributeName] = attributeValue;
                 i = attributeValueEndIndex + 1;
+            } else {
+                //Unquoted value ends with first white char
+                size_t attributeValueEndIndex = stringUtils::nextWhiteChar(
+                        tagBody,
+                        attributeValueStartIndex,
+                        length
+                );
+                if (attributeValueEndIndex == std::string::npos) {
+                    attributeValueEndIndex = length;
+                }
+                attributeValue = tagBody.substr(
+                        attributeValueStartIndex,
+                        attributeValueEndIndex - attributeValueStartIndex
+                );
+                i = attributeValueEndIndex;
             }
+
+            stringUtils::trim(attributeValue);
+            //First occurrence of attribute wins, same as in browsers
+            outMap.emplace(attributeName, attributeValue);
         }
     }
 
 
     /**
      * Extracts name of tag from tagBody. This doesnt means name attribute but tag itself,
-     * e.g. <code>&lt;p&gt; -> p</code>
+     * e.g. <code>&lt;p&gt; -> p</code>. Name of closing tag keeps '/' at the beginning,
+     * e.g. <code>&lt;/p&gt; -> /p</code>.
      * @param tagBody Tag body without '<' and '>' chars to extract name from.
-     * @return Name of the tag, value of "name" parameter.
+     * @return Name of the tag as view into tagBody.
      * @since 1.0.0
      */
-    std::string getTagName(const std::string &tagBody) {
-        std::string name = std::string(tagBody);
+    template<typename CharT>
+    std::basic_string_view<CharT> getTagName(const std::basic_string_view<CharT> &tagBody) {
+        size_t length = tagBody.length();
+        size_t s = stringUtils::nextNonWhiteChar(tagBody, 0, length);
+        if (s == std::string::npos) {
+            return {};
+        }
 
-        if (tagBody.find(' ')) {
-            size_t ei = stringUtils::indexOf(tagBody, " ", 0);
-            if (ei > 0) {
-                name = tagBody.substr(0, ei);
-            }
+        //Skipping first char so '/' of closing tag is kept in the name
+        size_t e = s + 1;
+        while (e < length && tagBody[e] != '/'
+               && !stringUtils::isWhiteChar(tagBody[e])) {
+            e += 1;
         }
-        // TODO improve
-        stringUtils::trim(name);
-        return name;
+        return tagBody.substr(s, e - s);
     }
 
 
@@ -207,12 +152,13 @@ namespace htmlUtils {
     *
      * @param input Value of "class" attribute without wrapper chars (start/end "/' has to be removed
      * before).
-    * @param outList Mutable list for holding extracted classes.
+    * @param outList Mutable list for holding extracted classes, classes are views into input.
      * @since 1.0.0
     */
+    template<typename CharT, typename List>
     void extractClassesFromString(
-            const std::string_view &input,
-            std::vector<std::string> &outList
+            const std::basic_string_view<CharT> &input,
+            List &outList
     ) {
         size_t length = input.length();
 
@@ -220,31 +166,18 @@ namespace htmlUtils {
             outList.clear();
         }
 
-        size_t s = std::string::npos;
-        size_t e = std::string::npos;
-        for (size_t i = 0; i < length; ++i) {
-            char ch = input[i];
-
-            if (stringUtils::isWhiteChar(ch)) {
-                if (s != e && s != std::string::npos && e != std::string::npos) {
-                    //+1 because is set on last non white char, needs to include it on substring length too
-                    outList.emplace_back(input.substr(s, e - s + 1));
-                    s = std::string::npos;
-                    e = std::string::npos;
-                }
-            } else {
-                if (s == std::string::npos) {
-                    s = i;
-                }
-                e = i;
+        size_t i = 0;
+        while (i < length) {
+            size_t s = stringUtils::nextNonWhiteChar(input, i, length);
+            if (s == std::string::npos) {
+                return;
             }
-        }
-
-
-        //Checking if there is not class left
-        if (s != e && s != std::string::npos && e != std::string::npos) {
-            //+1 because is set on last non white char, needs to include it on substring length too
-            outList.emplace_back(input.substr(s, e - s + 1));
+            size_t e = stringUtils::nextWhiteChar(input, s, length);
+            if (e == std::string::npos) {
+                e = length;
+            }
+            outList.emplace_back(input.substr(s, e - s));
+            i = e;
         }
     }
 
@@ -257,94 +190,17 @@ namespace htmlUtils {
      */
     void extractClasses(
             const std::string_view &tagBody,
-            std::vector<std::string> &outList
+            std::vector<std::string_view> &outList
     ) {
-        std::string separator = "class=";
-        size_t s = stringUtils::indexOf(tagBody, separator, 0);
-        if (s == std::string::npos) {
+        std::map<std::string_view, std::string_view> attributes;
+        getTagAttributes(tagBody, attributes);
+
+        auto classAttribute = attributes.find("class");
+        if (classAttribute == attributes.end()) {
             //Tag has no clazz
             return;
         }
-
-        if (!outList.empty()) {
-            outList.clear();
-        }
-
-        //s + 6 is next char after class=
-        size_t valueStartIndex = stringUtils::nextNonWhiteChar(
-                tagBody,
-                s + 6,
-                tagBody.length()
-        );
-
-        //Can be " or '
-        char valueContainerChar = tagBody[valueStartIndex];
-
-        //searching for valueContainerChar ending char
-        size_t valueEndIndex = stringUtils::indexOfOrThrow(
-                tagBody,
-                valueContainerChar,
-                valueStartIndex + 1
-        );
-
-        //-1 to remove "/'on the end
-        std::string_view classValue = tagBody.substr(
-                valueStartIndex + 1,
-                valueEndIndex - valueStartIndex - 1
-        );
-        //+1 to skip "/'on the beginning
-        return extractClassesFromString(classValue, outList);
-    }
-
-
-    /**
-     * TODO docs
-     * @param text
-     */
-    void normalizeText(
-            std::string &text
-    ) {
-        // Trim leading and trailing whitespace
-        auto start = text.begin();
-        while (start != text.end() && std::isspace(static_cast<unsigned char>(*start))) {
-            ++start;
-        }
-
-        auto end = text.end();
-        while (end != start && std::isspace(static_cast<unsigned char>(*(end - 1)))) {
-            --end;
-        }
-
-        // Keep only one space at the beginning and end if there was any whitespace
-        bool hasLeadingSpace = (start != text.begin());
-        bool hasTrailingSpace = (end != text.end());
-
-        // Reduce the middle whitespace and remove invalid characters
-        auto writeIt = text.begin();
-        bool inWhitespace = false;
-
-        for (auto it = start; it != end; ++it) {
-            if (std::isspace(static_cast<unsigned char>(*it))) {
-                if (!inWhitespace) {
-                    *writeIt++ = ' '; // Replace first whitespace sequence with a single space
-                    inWhitespace = true;
-                }
-            } else {
-                *writeIt++ = *it; // Copy non-whitespace characters
-                inWhitespace = false;
-            }
-        }
-
-        // Resize the string to remove the excess characters
-        text.erase(writeIt, text.end());
-
-        // Add leading and trailing spaces if needed
-        if (hasLeadingSpace) {
-            text.insert(text.begin(), ' ');
-        }
-        if (hasTrailingSpace) {
-            text.push_back(' ');
-        }
+        extractClassesFromString(classAttribute->second, outList);
     }
 
 
@@ -354,36 +210,26 @@ namespace htmlUtils {
      * @return True if tag from @tagBody is single tag, false when tag is pair tag.
      * @since 1.0.0
      */
-    bool isSingleTag(const std::string &tagBody) {
-        size_t lastIndex = tagBody.length() - 1;
-        bool hasClosing = tagBody.find('/', lastIndex) != std::string::npos;
-        if (hasClosing) {
+    bool isSingleTag(const std::string_view &tagBody) {
+        if (stringUtils::endsWith(tagBody, '/')) {
             return true;
         }
 
-        std::string tagName = htmlUtils::getTagName(tagBody);
-        auto result = std::find(
-                singleTagsIteratorBegin,
-                singleTagsIteratorEnd,
-                tagName
-        );
-
-        if (result != singleTagsIteratorEnd) {
-            return true;
-        } else {
-            return false;
-        }
+        std::string_view tagName = htmlUtils::getTagName(tagBody);
+        htmlNames::TagId id = htmlNames::getTagId(tagName);
+        return (htmlNames::getTagFlags(id) & htmlNames::TAG_FLAG_VOID) != 0;
     }
 
 
     /**
-     *
-     * @param tag
-     * @return
+     * Checks whatever tag is inline text style tag, e.g. &lt;b&gt;.
+     * @param tag Name of the tag.
+     * @return True if tag is inline text style tag.
      * @since 1.0.0
      */
-    bool isInlineTag(const std::string &tag) {
-        return textStyleTags.find(tag) != textStyleTags.end();
+    bool isInlineTag(const std::string_view &tag) {
+        htmlNames::TagId id = htmlNames::getTagId(tag);
+        return (htmlNames::getTagFlags(id) & htmlNames::TAG_FLAG_INLINE) != 0;
     }
 
 
@@ -8,19 +8,348 @@
 
 
 #include <jni.h>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include "HtmlIterator.h"
 #include "DebugLogCallback.h"
+#include "EventFilter.h"
+#include "JniCache.h"
+#include "JniEventBatchCallback.h"
 #include "JniHtmlIteratorCallback.h"
+#include "JniSelectorCallback.h"
+#include "JniTagInfo.h"
+#include "WorkStealingPool.h"
 
 //Caller jobject htmlIterator is almost never used bust must be declared for jni functions.
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "UnusedParameter"
 
 namespace jni {
-    HtmlIterator *instance = new HtmlIterator();
+
+
+    /**
+     * Native state of one kotlin <code>HtmlIterator</code>, created by
+     * <code>createNativeHandle</code> and deleted by <code>destroyNativeHandle</code>. Handles
+     * share no state, so different handles can be used from different threads at once.
+     * @since 1.0.0
+     */
+    class IteratorHandle {
+
+    public:
+
+        /**
+         * Iterator of UTF-8 content, set from files, byte buffers or byte arrays.
+         */
+        HtmlIterator instance;
+
+        /**
+         * Iterator of UTF-16 content, set from java strings without transcoding them.
+         */
+        HtmlIterator16 instance16;
+
+        /**
+         * True when current content was set from java string, so it's iterated by
+         * <code>instance16</code>.
+         */
+        bool isUtf16Content = false;
+
+        JniHtmlIteratorCallback<char> *callback = nullptr;
+        JniHtmlIteratorCallback<char16_t> *callback16 = nullptr;
+
+        /**
+         * Filter of results set by <code>setFilter</code>, evaluated by filtering callbacks before
+         * results reach <code>callback</code> and <code>callback16</code>.
+         */
+        EventFilter filter;
+        FilteringCallback<char> filteringCallback = FilteringCallback<char>(&filter, nullptr);
+        FilteringCallback<char16_t> filteringCallback16 = FilteringCallback<char16_t>(&filter, nullptr);
+
+        /**
+         * Global reference to direct ByteBuffer or byte array borrowed by the instance as its
+         * content, keeps the memory alive while it's iterated.
+         */
+        jobject borrowedContentRef = nullptr;
+
+        /**
+         * Elements of borrowed byte array, need to be released together with
+         * <code>borrowedContentRef</code>.
+         */
+        jbyte *borrowedBytes = nullptr;
+
+
+        /**
+         * Releases content borrowed from java, must be called before instance gets another content.
+         * @since 1.0.0
+         */
+        void releaseBorrowedContent(JNIEnv *environment) {
+            if (borrowedContentRef == nullptr) {
+                return;
+            }
+            //Clearing first so instance doesn't point into released memory
+            instance.clear();
+            if (borrowedBytes != nullptr) {
+                environment->ReleaseByteArrayElements(
+                        static_cast<jbyteArray>(borrowedContentRef),
+                        borrowedBytes,
+                        JNI_ABORT
+                );
+                borrowedBytes = nullptr;
+            }
+            environment->DeleteGlobalRef(borrowedContentRef);
+            borrowedContentRef = nullptr;
+        }
+
+
+        /**
+         * Selects iterator for the next content, content of the other iterator is cleared.
+         * @param isUtf16 True when next content is java string.
+         * @since 1.0.0
+         */
+        void useUtf16Content(bool isUtf16) {
+            if (isUtf16) {
+                instance.clear();
+            } else {
+                instance16.clear();
+            }
+            isUtf16Content = isUtf16;
+        }
+
+
+        /**
+         * Replaces callbacks of both iterators, previous callbacks are deleted.
+         * @since 1.0.0
+         */
+        void setCallback(JNIEnv *environment, jobject kotlinCallback) {
+            if (kotlinCallback == nullptr) {
+                replaceCallbacks(environment, nullptr, nullptr);
+                return;
+            }
+            replaceCallbacks(
+                    environment,
+                    new JniHtmlIteratorCallback<char>(environment, kotlinCallback),
+                    new JniHtmlIteratorCallback<char16_t>(environment, kotlinCallback)
+            );
+        }
+
+
+        /**
+         * Replaces callbacks of both iterators by callbacks delivering results to
+         * <code>decoder</code> in batches, see JniEventBatchCallback.
+         * @since 1.0.0
+         */
+        void setEventBatchCallback(JNIEnv *environment, jobject decoder, size_t maxEventsCount) {
+            replaceCallbacks(
+                    environment,
+                    new JniEventBatchCallback<char>(environment, decoder, maxEventsCount),
+                    new JniEventBatchCallback<char16_t>(environment, decoder, maxEventsCount)
+            );
+        }
+
+
+        /**
+         * Replaces callbacks of both iterators by callbacks delivering elements matching selectors
+         * to <code>selectorCallback</code>, see JniSelectorCallback.
+         * @since 1.0.0
+         */
+        void setSelectorCallback(
+                JNIEnv *environment,
+                jobject selectorCallback,
+                std::vector<CssSelector> &&selectors,
+                std::vector<BasicCssSelector<char16_t>> &&selectors16
+        ) {
+            replaceCallbacks(
+                    environment,
+                    new JniSelectorCallback<char>(environment, selectorCallback, std::move(selectors)),
+                    new JniSelectorCallback<char16_t>(environment, selectorCallback, std::move(selectors16))
+            );
+        }
+
+
+        /**
+         * Replaces filter of results, iterators get filtering callbacks only while filter is not
+         * empty, so results are not passed through the filter needlessly.
+         * @since 1.0.0
+         */
+        void setFilter(EventFilter &&newFilter) {
+            filter = std::move(newFilter);
+            attachCallbacks();
+        }
+
+
+        /**
+         * Sets callbacks to iterators, through filtering callbacks when filter is not empty. Must be
+         * called whenever callbacks or filter are changed.
+         * @since 1.0.0
+         */
+        void attachCallbacks() {
+            if (filter.isEmpty() || callback == nullptr) {
+                instance.setCallback(callback);
+                instance16.setCallback(callback16);
+                return;
+            }
+            filteringCallback.setTarget(callback);
+            filteringCallback16.setTarget(callback16);
+            instance.setCallback(&filteringCallback);
+            instance16.setCallback(&filteringCallback16);
+        }
+
+
+        /**
+         * Delivers results held back by callbacks, must be called by every function which may invoke
+         * callback before it returns to java.
+         * @since 1.0.0
+         */
+        void flush() {
+            if (callback != nullptr) {
+                callback->flush();
+            }
+            if (callback16 != nullptr) {
+                callback16->flush();
+            }
+        }
+
+
+        /**
+         * Drops state of callbacks of previous content, must be called when new content is set.
+         * @since 1.0.0
+         */
+        void resetCallbacks(JNIEnv *environment) {
+            setEnvironment(environment);
+            if (callback != nullptr) {
+                callback->reset();
+            }
+            if (callback16 != nullptr) {
+                callback16->reset();
+            }
+        }
+
+
+        /**
+         * Passes environment of calling thread to callbacks, must be called by every function
+         * which may invoke callback.
+         * @since 1.0.0
+         */
+        void setEnvironment(JNIEnv *environment) {
+            if (callback != nullptr) {
+                callback->setEnvironment(environment);
+            }
+            if (callback16 != nullptr) {
+                callback16->setEnvironment(environment);
+            }
+        }
+
+
+        /**
+         * Calls action with iterator holding current content.
+         * @param action Generic lambda accepting <code>BasicHtmlIterator</code> of any code unit type.
+         * @return Result of the action.
+         * @since 1.0.0
+         */
+        template<typename Action>
+        auto withCurrentInstance(Action action) {
+            if (isUtf16Content) {
+                return action(instance16);
+            }
+            return action(instance);
+        }
+
+
+        /**
+         * Releases all java references held by handle, must be called before handle is deleted.
+         * @since 1.0.0
+         */
+        void release(JNIEnv *environment) {
+            releaseBorrowedContent(environment);
+            setCallback(environment, nullptr);
+        }
+
+
+    private:
+
+        void replaceCallbacks(
+                JNIEnv *environment,
+                JniHtmlIteratorCallback<char> *newCallback,
+                JniHtmlIteratorCallback<char16_t> *newCallback16
+        ) {
+            JniHtmlIteratorCallback<char> *oldCallback = callback;
+            JniHtmlIteratorCallback<char16_t> *oldCallback16 = callback16;
+            callback = newCallback;
+            callback16 = newCallback16;
+            attachCallbacks();
+            setEnvironment(environment);
+            //Destructors release java references, environment of their last use may belong to
+            //another thread
+            if (oldCallback != nullptr) {
+                oldCallback->setEnvironment(environment);
+            }
+            if (oldCallback16 != nullptr) {
+                oldCallback16->setEnvironment(environment);
+            }
+            delete oldCallback;
+            delete oldCallback16;
+        }
+    };
+
+
+    /**
+     * Gets handle of kotlin iterator from its <code>nativeHandle</code> field.
+     * @return Handle of the iterator or nullptr when iterator was closed, IllegalStateException is
+     * thrown to java in that case.
+     * @since 1.0.0
+     */
+    IteratorHandle *getHandle(JNIEnv *environment, jobject htmlIterator) {
+        auto *handle = reinterpret_cast<IteratorHandle *>(
+                environment->GetLongField(htmlIterator, jniCache::nativeHandle)
+        );
+        if (handle == nullptr) {
+            environment->ThrowNew(jniCache::illegalStateExceptionClass, "HtmlIterator is closed");
+        }
+        return handle;
+    }
+
+
+    /**
+     * Calls action with every string of java array as UTF-8 view.
+     * @param names Array of java strings.
+     * @param action Function accepting <code>std::string_view</code>.
+     * @since 1.0.0
+     */
+    template<typename Action>
+    void forEachName(JNIEnv *environment, jobjectArray names, Action action) {
+        jsize count = environment->GetArrayLength(names);
+        for (jsize i = 0; i < count; i++) {
+            auto name = static_cast<jstring>(environment->GetObjectArrayElement(names, i));
+            const char *chars = environment->GetStringUTFChars(name, nullptr);
+            action(std::string_view(chars, environment->GetStringUTFLength(name)));
+            environment->ReleaseStringUTFChars(name, chars);
+            environment->DeleteLocalRef(name);
+        }
+    }
+}
+
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_htmliterator_HtmlIterator_createNativeHandle(
+        JNIEnv *environment,
+        jobject htmlIterator
+) {
+    return reinterpret_cast<jlong>(new jni::IteratorHandle());
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_destroyNativeHandle(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jlong nativeHandle
+) {
+    auto *handle = reinterpret_cast<jni::IteratorHandle *>(nativeHandle);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->release(environment);
+    delete handle;
+}
 
 extern "C" JNIEXPORT void JNICALL
 Java_com_htmliterator_HtmlIterator_setContent(
@@ -28,40 +357,429 @@ Java_com_htmliterator_HtmlIterator_setContent(
         jobject htmlIterator,
         jstring content
 ) {
-    jboolean isCopy = false;
-    std::string input = environment->GetStringUTFChars(content, &isCopy);
-    jni::instance->setContent(input);
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->releaseBorrowedContent(environment);
+    handle->useUtf16Content(true);
+    handle->resetCallbacks(environment);
+    //Java string is copied once as it is, no transcoding to UTF-8
+    jsize length = environment->GetStringLength(content);
+    std::u16string input(length, u'\0');
+    environment->GetStringRegion(content, 0, length, reinterpret_cast<jchar *>(input.data()));
+    handle->instance16.setContent(std::move(input));
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_htmliterator_HtmlIterator_setContentFromBuffer(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jobject buffer,
+        jint offset,
+        jint length
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return false;
+    }
+    handle->releaseBorrowedContent(environment);
+    handle->useUtf16Content(false);
+    handle->resetCallbacks(environment);
+    auto *address = static_cast<const char *>(environment->GetDirectBufferAddress(buffer));
+    if (address == nullptr) {
+        platformUtils::log("HtmlIterator", "Buffer is not a direct buffer", ANDROID_LOG_ERROR);
+        handle->instance.clear();
+        return false;
+    }
+    handle->borrowedContentRef = environment->NewGlobalRef(buffer);
+    handle->instance.setBorrowedContent(std::string_view(address + offset, length));
+    return true;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_setContentFromBytes(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jbyteArray bytes,
+        jint offset,
+        jint length
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->releaseBorrowedContent(environment);
+    handle->useUtf16Content(false);
+    handle->resetCallbacks(environment);
+    //Non movable arrays (large ones) are not copied by runtime, others are copied once
+    jbyte *elements = environment->GetByteArrayElements(bytes, nullptr);
+    handle->borrowedContentRef = environment->NewGlobalRef(bytes);
+    handle->borrowedBytes = elements;
+    handle->instance.setBorrowedContent(
+            std::string_view(reinterpret_cast<const char *>(elements) + offset, length)
+    );
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_htmliterator_HtmlIterator_setContentFromFile(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jstring path
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return false;
+    }
+    handle->releaseBorrowedContent(environment);
+    handle->useUtf16Content(false);
+    handle->resetCallbacks(environment);
+    const char *chars = environment->GetStringUTFChars(path, nullptr);
+    std::string input = std::string(chars);
+    environment->ReleaseStringUTFChars(path, chars);
+    return handle->instance.setContentFromFile(input);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_htmliterator_HtmlIterator_setContentFromFileDescriptor(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jint fd
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return false;
+    }
+    handle->releaseBorrowedContent(environment);
+    handle->useUtf16Content(false);
+    handle->resetCallbacks(environment);
+    return handle->instance.setContentFromFileDescriptor(fd);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_feed(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jstring chunk
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->releaseBorrowedContent(environment);
+    if (!handle->isUtf16Content || handle->instance16.isFeedStartingNewContent()) {
+        //Tags of previous content are destroyed by the first chunk, same as by setContent
+        handle->resetCallbacks(environment);
+    } else {
+        handle->setEnvironment(environment);
+    }
+    handle->useUtf16Content(true);
+    const jchar *chars = environment->GetStringChars(chunk, nullptr);
+    jsize length = environment->GetStringLength(chunk);
+    handle->instance16.feed(std::u16string_view(reinterpret_cast<const char16_t *>(chars), length));
+    environment->ReleaseStringChars(chunk, chars);
+    handle->flush();
+}
+
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_finish(
+        JNIEnv *environment,
+        jobject htmlIterator
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->setEnvironment(environment);
+    handle->withCurrentInstance([](auto &iterator) {
+        iterator.finish();
+    });
+    handle->flush();
 }
 
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_htmliterator_HtmlIterator_setCallback(
         JNIEnv *environment,
         jobject htmlIterator,
         jobject callback
 ) {
-    jni::instance->setCallback(
-            new JniHtmlIteratorCallback(
-                    environment,
-                    callback
-            )
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->setCallback(environment, callback);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_setEventBatchDecoder(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jobject decoder,
+        jint maxEventsCount
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->setEventBatchCallback(environment, decoder, static_cast<size_t>(maxEventsCount));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_setSelectors(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jobjectArray selectors,
+        jobject selectorCallback
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    //Selectors are compiled for both iterators, UTF-16 ones from java string as it is
+    jsize count = environment->GetArrayLength(selectors);
+    std::vector<CssSelector> compiledSelectors(count);
+    std::vector<BasicCssSelector<char16_t>> compiledSelectors16(count);
+    for (jsize i = 0; i < count; i++) {
+        auto selector = static_cast<jstring>(environment->GetObjectArrayElement(selectors, i));
+        const char *chars = environment->GetStringUTFChars(selector, nullptr);
+        bool isValid = compiledSelectors[i].parse(
+                std::string_view(chars, environment->GetStringUTFLength(selector))
+        );
+        const jchar *chars16 = environment->GetStringChars(selector, nullptr);
+        isValid = isValid && compiledSelectors16[i].parse(
+                std::u16string_view(
+                        reinterpret_cast<const char16_t *>(chars16),
+                        environment->GetStringLength(selector)
+                )
+        );
+        environment->ReleaseStringChars(selector, chars16);
+        if (!isValid) {
+            std::string message = std::string("Invalid selector: ") + chars;
+            environment->ReleaseStringUTFChars(selector, chars);
+            environment->DeleteLocalRef(selector);
+            environment->ThrowNew(jniCache::illegalArgumentExceptionClass, message.c_str());
+            return;
+        }
+        environment->ReleaseStringUTFChars(selector, chars);
+        environment->DeleteLocalRef(selector);
+    }
+    handle->setSelectorCallback(
+            environment,
+            selectorCallback,
+            std::move(compiledSelectors),
+            std::move(compiledSelectors16)
     );
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_setEventFilter(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jobjectArray tagNames,
+        jobjectArray skippedTagNames,
+        jboolean isTextReported,
+        jobjectArray requiredAttributes
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    EventFilter filter;
+    jni::forEachName(environment, tagNames, [&filter](std::string_view name) {
+        filter.addReportedTag(name);
+    });
+    jni::forEachName(environment, skippedTagNames, [&filter](std::string_view name) {
+        filter.addSkippedTag(name);
+    });
+    jni::forEachName(environment, requiredAttributes, [&filter](std::string_view name) {
+        filter.addRequiredAttribute(name);
+    });
+    filter.setTextReported(static_cast<bool>(isTextReported));
+    handle->setFilter(std::move(filter));
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_htmliterator_HtmlIterator_iterate(
         JNIEnv *environment,
-        jobject htmlIterato
+        jobject htmlIterator
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->setEnvironment(environment);
+    handle->withCurrentInstance([](auto &iterator) {
+        iterator.iterate();
+    });
+    handle->flush();
+}
+
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_setIsParallelTokenizationEnabled(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jboolean isEnabled
 ) {
-    jni::instance->iterate();
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->instance.setParallelTokenizationEnabled(static_cast<bool>(isEnabled));
+    handle->instance16.setParallelTokenizationEnabled(static_cast<bool>(isEnabled));
+}
+
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_htmliterator_HtmlIterator_getIsParallelTokenizationEnabled(
+        JNIEnv *environment,
+        jobject htmlIterator
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return false;
+    }
+    return static_cast<jboolean>(handle->instance16.getIsParallelTokenizationEnabled());
+}
+
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_htmliterator_HtmlIterator_extractText(
+        JNIEnv *environment,
+        jobject htmlIterator
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    return handle->withCurrentInstance([environment](auto &iterator) {
+        auto text = iterator.extractText();
+        using CharT = typename decltype(text)::value_type;
+        return jniTagInfo::newString(environment, std::basic_string_view<CharT>(text));
+    });
+}
+
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_iterateDocuments(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jobjectArray documents,
+        jobject callbackFactory
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    JavaVM *javaVm = nullptr;
+    environment->GetJavaVM(&javaVm);
+    //Local references are valid only on calling thread
+    auto documentsRef = static_cast<jobjectArray>(environment->NewGlobalRef(documents));
+    jobject callbackFactoryRef = environment->NewGlobalRef(callbackFactory);
+    auto documentsCount = static_cast<size_t>(environment->GetArrayLength(documents));
+    bool isClosingTagIndexEnabled = handle->instance16.getIsClosingTagIndexEnabled();
+    //Filter is only read by workers, so they can share it
+    const EventFilter &filter = handle->filter;
+
+    std::mutex exceptionMutex;
+    jobject exceptionRef = nullptr;
+    std::atomic<bool> isFailed = false;
+
+    WorkStealingPool pool;
+    pool.run(documentsCount, [&](size_t workerIndex) {
+        JNIEnv *workerEnvironment = environment;
+        if (workerIndex != 0
+            && javaVm->AttachCurrentThread(&workerEnvironment, nullptr) != JNI_OK) {
+            //Tasks of the worker are taken by other workers
+            return;
+        }
+        //Every worker reuses its iterator for all of its documents. Documents are already
+        //iterated in parallel, lexing them in parallel too would start threads for every core
+        //from every worker.
+        HtmlIterator16 iterator;
+        iterator.setClosingTagIndexEnabled(isClosingTagIndexEnabled);
+        iterator.setParallelTokenizationEnabled(false);
+
+        size_t documentIndex;
+        while (!isFailed && pool.takeTask(workerIndex, documentIndex)) {
+            //Attached threads free local references only on detach, frame frees them per document
+            workerEnvironment->PushLocalFrame(16);
+            jobject callback = workerEnvironment->CallObjectMethod(
+                    callbackFactoryRef,
+                    jniCache::createCallback,
+                    static_cast<jint>(documentIndex)
+            );
+            if (!workerEnvironment->ExceptionCheck()) {
+                auto document = static_cast<jstring>(
+                        workerEnvironment->GetObjectArrayElement(
+                                documentsRef,
+                                static_cast<jsize>(documentIndex)
+                        )
+                );
+                jsize length = workerEnvironment->GetStringLength(document);
+                std::u16string input(length, u'\0');
+                workerEnvironment->GetStringRegion(
+                        document,
+                        0,
+                        length,
+                        reinterpret_cast<jchar *>(input.data())
+                );
+                JniHtmlIteratorCallback<char16_t> jniCallback(workerEnvironment, callback);
+                FilteringCallback<char16_t> filteringCallback(&filter, &jniCallback);
+                if (filter.isEmpty()) {
+                    iterator.setCallback(&jniCallback);
+                } else {
+                    iterator.setCallback(&filteringCallback);
+                }
+                iterator.setContent(std::move(input));
+                iterator.iterate();
+                iterator.setCallback(nullptr);
+                iterator.clear();
+            }
+
+            jthrowable exception = workerEnvironment->ExceptionOccurred();
+            if (exception != nullptr) {
+                workerEnvironment->ExceptionClear();
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (exceptionRef == nullptr) {
+                    exceptionRef = workerEnvironment->NewGlobalRef(exception);
+                }
+                isFailed = true;
+            }
+            workerEnvironment->PopLocalFrame(nullptr);
+        }
+
+        if (workerIndex != 0) {
+            javaVm->DetachCurrentThread();
+        }
+    });
+
+    environment->DeleteGlobalRef(documentsRef);
+    environment->DeleteGlobalRef(callbackFactoryRef);
+    if (exceptionRef != nullptr) {
+        //First exception thrown by any callback is rethrown on calling thread
+        environment->Throw(static_cast<jthrowable>(exceptionRef));
+        environment->DeleteGlobalRef(exceptionRef);
+    }
 }
 
 
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_htmliterator_HtmlIterator_iterateSingleStep(
         JNIEnv *environment,
-        jobject htmlIterato
+        jobject htmlIterator
 ) {
-    bool canIterate = jni::instance->iterateSingleIteration();
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return false;
+    }
+    handle->setEnvironment(environment);
+    bool canIterate = handle->withCurrentInstance([](auto &iterator) {
+        return iterator.iterateSingleIteration();
+    });
+    handle->flush();
     return static_cast<jboolean>(canIterate);
 }
 
@@ -72,15 +790,23 @@ Java_com_htmliterator_HtmlIterator_setContentAndIterateDebug(
         jobject htmlIterator,
         jstring content
 ) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->releaseBorrowedContent(environment);
+    handle->useUtf16Content(false);
     auto *callback = new DebugLogCallback();
-    jboolean isCopy = false;
-    std::string input = environment->GetStringUTFChars(content, &isCopy);
-    jni::instance->setContent(input);
-    jni::instance->setCallback(callback);
-    jni::instance->iterate();
+    const char *chars = environment->GetStringUTFChars(content, nullptr);
+    jsize length = environment->GetStringUTFLength(content);
+    handle->instance.setContent(std::string_view(chars, length));
+    environment->ReleaseStringUTFChars(content, chars);
+    handle->instance.setCallback(callback);
+    handle->instance.iterate();
 
-    callback = nullptr;
-    jni::instance->clear();
+    handle->attachCallbacks();
+    delete callback;
+    handle->instance.clear();
 }
 
 
@@ -89,7 +815,197 @@ Java_com_htmliterator_HtmlIterator_getIsContentFullHtmlDocument(
         JNIEnv *environment,
         jobject htmlIterator
 ) {
-    return static_cast<jboolean>(jni::instance->isContentFullHtmlDocument());
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return false;
+    }
+    return static_cast<jboolean>(handle->withCurrentInstance([](auto &iterator) {
+        return iterator.isContentFullHtmlDocument();
+    }));
+}
+
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_htmliterator_HtmlIterator_setIsClosingTagIndexEnabled(
+        JNIEnv *environment,
+        jobject htmlIterator,
+        jboolean isEnabled
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return;
+    }
+    handle->instance.setClosingTagIndexEnabled(static_cast<bool>(isEnabled));
+    handle->instance16.setClosingTagIndexEnabled(static_cast<bool>(isEnabled));
+}
+
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_htmliterator_HtmlIterator_getIsClosingTagIndexEnabled(
+        JNIEnv *environment,
+        jobject htmlIterator
+) {
+    auto *handle = jni::getHandle(environment, htmlIterator);
+    if (handle == nullptr) {
+        return false;
+    }
+    return static_cast<jboolean>(handle->instance16.getIsClosingTagIndexEnabled());
+}
+
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_htmliterator_TagInfo_nativeGetTag(
+        JNIEnv *environment,
+        jobject tagInfo,
+        jlong nativeTag,
+        jboolean isUtf16
+) {
+    return jniTagInfo::withNativeTag(nativeTag, isUtf16, [environment](auto &tag) {
+        return jniTagInfo::newString(environment, tag.getTag());
+    });
+}
+
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_htmliterator_TagInfo_nativeGetBody(
+        JNIEnv *environment,
+        jobject tagInfo,
+        jlong nativeTag,
+        jboolean isUtf16
+) {
+    return jniTagInfo::withNativeTag(nativeTag, isUtf16, [environment](auto &tag) {
+        return jniTagInfo::newString(environment, tag.getBody());
+    });
+}
+
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_htmliterator_TagInfo_nativeGetAttributes(
+        JNIEnv *environment,
+        jobject tagInfo,
+        jlong nativeTag,
+        jboolean isUtf16
+) {
+    return jniTagInfo::withNativeTag(nativeTag, isUtf16, [environment](auto &tag) {
+        return jniTagInfo::newAttributes(environment, tag);
+    });
+}
+
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_htmliterator_TagInfo_nativeGetClasses(
+        JNIEnv *environment,
+        jobject tagInfo,
+        jlong nativeTag,
+        jboolean isUtf16
+) {
+    return jniTagInfo::withNativeTag(nativeTag, isUtf16, [environment](auto &tag) {
+        return jniTagInfo::newClasses(environment, tag);
+    });
+}
+
+
+/**
+ * Natives of kotlin <code>HtmlIterator</code>, bound by <code>RegisterNatives</code> in
+ * <code>JNI_OnLoad</code>, so runtime doesn't have to look them up by symbol name on first call.
+ */
+static const JNINativeMethod htmlIteratorMethods[] = {
+        {"createNativeHandle",           "()J",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_createNativeHandle)},
+        {"destroyNativeHandle",          "(J)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_destroyNativeHandle)},
+        {"setContent",                   "(Ljava/lang/String;)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setContent)},
+        {"setContentFromBuffer",         "(Ljava/nio/ByteBuffer;II)Z",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setContentFromBuffer)},
+        {"setContentFromBytes",          "([BII)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setContentFromBytes)},
+        {"setContentFromFile",           "(Ljava/lang/String;)Z",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setContentFromFile)},
+        {"setContentFromFileDescriptor", "(I)Z",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setContentFromFileDescriptor)},
+        {"feed",                         "(Ljava/lang/String;)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_feed)},
+        {"finish",                       "()V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_finish)},
+        {"setCallback",                  "(Lcom/htmliterator/HtmlIterator$Callback;)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setCallback)},
+        {"setEventBatchDecoder",         "(Lcom/htmliterator/EventBatchDecoder;I)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setEventBatchDecoder)},
+        {"setSelectors",                 "([Ljava/lang/String;Lcom/htmliterator/HtmlIterator$SelectorCallback;)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setSelectors)},
+        {"setEventFilter",               "([Ljava/lang/String;[Ljava/lang/String;Z[Ljava/lang/String;)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setEventFilter)},
+        {"iterate",                      "()V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_iterate)},
+        {"extractText",                  "()Ljava/lang/String;",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_extractText)},
+        {"iterateDocuments",             "([Ljava/lang/String;Lcom/htmliterator/HtmlIterator$CallbackFactory;)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_iterateDocuments)},
+        {"iterateSingleStep",            "()Z",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_iterateSingleStep)},
+        {"setContentAndIterateDebug",    "(Ljava/lang/String;)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setContentAndIterateDebug)},
+        {"getIsContentFullHtmlDocument", "()Z",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_getIsContentFullHtmlDocument)},
+        {"setIsClosingTagIndexEnabled",  "(Z)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setIsClosingTagIndexEnabled)},
+        {"getIsClosingTagIndexEnabled",  "()Z",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_getIsClosingTagIndexEnabled)},
+        {"setIsParallelTokenizationEnabled", "(Z)V",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_setIsParallelTokenizationEnabled)},
+        {"getIsParallelTokenizationEnabled", "()Z",
+                reinterpret_cast<void *>(Java_com_htmliterator_HtmlIterator_getIsParallelTokenizationEnabled)},
+};
+
+
+/**
+ * Natives of kotlin <code>TagInfo</code>, see jniTagInfo.
+ */
+static const JNINativeMethod tagInfoMethods[] = {
+        {"nativeGetTag",        "(JZ)Ljava/lang/String;",
+                reinterpret_cast<void *>(Java_com_htmliterator_TagInfo_nativeGetTag)},
+        {"nativeGetBody",       "(JZ)Ljava/lang/String;",
+                reinterpret_cast<void *>(Java_com_htmliterator_TagInfo_nativeGetBody)},
+        {"nativeGetAttributes", "(JZ)Ljava/util/Map;",
+                reinterpret_cast<void *>(Java_com_htmliterator_TagInfo_nativeGetAttributes)},
+        {"nativeGetClasses",    "(JZ)Ljava/util/List;",
+                reinterpret_cast<void *>(Java_com_htmliterator_TagInfo_nativeGetClasses)},
+};
+
+
+extern "C" JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM *javaVm, void *reserved) {
+    JNIEnv *environment = nullptr;
+    if (javaVm->GetEnv(reinterpret_cast<void **>(&environment), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+    if (!jniCache::load(environment)) {
+        return JNI_ERR;
+    }
+
+    jclass htmlIteratorClass = environment->FindClass("com/htmliterator/HtmlIterator");
+    if (htmlIteratorClass == nullptr) {
+        return JNI_ERR;
+    }
+    jint result = environment->RegisterNatives(
+            htmlIteratorClass,
+            htmlIteratorMethods,
+            sizeof(htmlIteratorMethods) / sizeof(JNINativeMethod)
+    );
+    environment->DeleteLocalRef(htmlIteratorClass);
+    if (result == JNI_OK) {
+        result = environment->RegisterNatives(
+                jniCache::tagInfoClass,
+                tagInfoMethods,
+                sizeof(tagInfoMethods) / sizeof(JNINativeMethod)
+        );
+    }
+    if (result != JNI_OK) {
+        platformUtils::log("HtmlIterator", "Unable to register natives", ANDROID_LOG_ERROR);
+        return JNI_ERR;
+    }
+    return JNI_VERSION_1_6;
 }
 
 
@@ -0,0 +1,178 @@
+#include <jni.h>
+#include "PlatformUtils.h"
+
+#ifndef ANDROID_HTML_ITERATOR_JNICACHE_H
+#define ANDROID_HTML_ITERATOR_JNICACHE_H
+
+
+/**
+ * Classes, methods and fields of java used by native code, resolved once by <code>load</code> from
+ * <code>JNI_OnLoad</code>. Classes are held by global references, so their ids stay valid. Ids are
+ * valid on any thread, also on threads attached by native code, where <code>FindClass</code> can't
+ * find classes of the library.
+ * @since 1.0.0
+ */
+namespace jniCache {
+
+    jclass tagInfoClass = nullptr;
+    jmethodID tagInfoConstructor = nullptr;
+    jfieldID tagInfoNativeTag = nullptr;
+
+    jclass hashMapClass = nullptr;
+    jmethodID hashMapConstructor = nullptr;
+    jmethodID hashMapPut = nullptr;
+
+    jclass arrayListClass = nullptr;
+    jmethodID arrayListConstructor = nullptr;
+    jmethodID arrayListAdd = nullptr;
+
+    jclass illegalStateExceptionClass = nullptr;
+    jclass illegalArgumentExceptionClass = nullptr;
+
+    /**
+     * Methods of <code>HtmlIterator.Callback</code>, calls are dispatched to overriding methods.
+     */
+    jmethodID onContentText = nullptr;
+    jmethodID onSingleTag = nullptr;
+    jmethodID onPairTag = nullptr;
+    jmethodID onLeavingPairTag = nullptr;
+    jmethodID onScript = nullptr;
+
+    jmethodID createCallback = nullptr;
+
+    /**
+     * <code>EventBatchDecoder.onEvents</code>, see JniEventBatchCallback.
+     */
+    jmethodID onEvents = nullptr;
+
+    /**
+     * <code>HtmlIterator.SelectorCallback.onMatch</code>, see JniSelectorCallback.
+     */
+    jmethodID onMatch = nullptr;
+
+    jfieldID nativeHandle = nullptr;
+
+
+    /**
+     * @param environment Jni environment.
+     * @param name Name of the class.
+     * @return Global reference to the class, nullptr when class was not found.
+     * @since 1.0.0
+     */
+    jclass findClass(JNIEnv *environment, const char *name) {
+        jclass localClass = environment->FindClass(name);
+        if (localClass == nullptr) {
+            platformUtils::log("JniCache", std::string("Unable to find class ") + name, ANDROID_LOG_ERROR);
+            return nullptr;
+        }
+        auto globalClass = static_cast<jclass>(environment->NewGlobalRef(localClass));
+        environment->DeleteLocalRef(localClass);
+        return globalClass;
+    }
+
+
+    /**
+     * Resolves all classes, methods and fields, must be called from <code>JNI_OnLoad</code> where
+     * class loader of the library is available.
+     * @param environment Jni environment.
+     * @return True when everything was resolved, false otherwise.
+     * @since 1.0.0
+     */
+    bool load(JNIEnv *environment) {
+        tagInfoClass = findClass(environment, "com/htmliterator/TagInfo");
+        hashMapClass = findClass(environment, "java/util/HashMap");
+        arrayListClass = findClass(environment, "java/util/ArrayList");
+        illegalStateExceptionClass = findClass(environment, "java/lang/IllegalStateException");
+        illegalArgumentExceptionClass = findClass(environment, "java/lang/IllegalArgumentException");
+        jclass callbackClass = environment->FindClass("com/htmliterator/HtmlIterator$Callback");
+        jclass callbackFactoryClass = environment->FindClass(
+                "com/htmliterator/HtmlIterator$CallbackFactory"
+        );
+        jclass eventBatchDecoderClass = environment->FindClass("com/htmliterator/EventBatchDecoder");
+        jclass selectorCallbackClass = environment->FindClass(
+                "com/htmliterator/HtmlIterator$SelectorCallback"
+        );
+        jclass htmlIteratorClass = environment->FindClass("com/htmliterator/HtmlIterator");
+        if (tagInfoClass == nullptr || hashMapClass == nullptr || arrayListClass == nullptr
+            || illegalStateExceptionClass == nullptr || illegalArgumentExceptionClass == nullptr
+            || callbackClass == nullptr || callbackFactoryClass == nullptr
+            || eventBatchDecoderClass == nullptr || selectorCallbackClass == nullptr
+            || htmlIteratorClass == nullptr) {
+            return false;
+        }
+
+        tagInfoConstructor = environment->GetMethodID(tagInfoClass, "<init>", "(JZZ)V");
+        tagInfoNativeTag = environment->GetFieldID(tagInfoClass, "nativeTag", "J");
+        hashMapConstructor = environment->GetMethodID(hashMapClass, "<init>", "()V");
+        hashMapPut = environment->GetMethodID(
+                hashMapClass,
+                "put",
+                "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;"
+        );
+        arrayListConstructor = environment->GetMethodID(arrayListClass, "<init>", "()V");
+        arrayListAdd = environment->GetMethodID(arrayListClass, "add", "(Ljava/lang/Object;)Z");
+
+        onContentText = environment->GetMethodID(
+                callbackClass,
+                "onContentText",
+                "(Ljava/lang/String;)V"
+        );
+        onSingleTag = environment->GetMethodID(
+                callbackClass,
+                "onSingleTag",
+                "(Lcom/htmliterator/TagInfo;)V"
+        );
+        onPairTag = environment->GetMethodID(
+                callbackClass,
+                "onPairTag",
+                "(Lcom/htmliterator/TagInfo;JJJJ)Z"
+        );
+        onLeavingPairTag = environment->GetMethodID(
+                callbackClass,
+                "onLeavingPairTag",
+                "(Lcom/htmliterator/TagInfo;JJ)V"
+        );
+        onScript = environment->GetMethodID(
+                callbackClass,
+                "onScript",
+                "(Lcom/htmliterator/TagInfo;)V"
+        );
+        createCallback = environment->GetMethodID(
+                callbackFactoryClass,
+                "createCallback",
+                "(I)Lcom/htmliterator/HtmlIterator$Callback;"
+        );
+        onEvents = environment->GetMethodID(
+                eventBatchDecoderClass,
+                "onEvents",
+                "(Ljava/nio/ByteBuffer;II)V"
+        );
+        onMatch = environment->GetMethodID(
+                selectorCallbackClass,
+                "onMatch",
+                "(Lcom/htmliterator/TagInfo;IJJ)V"
+        );
+        nativeHandle = environment->GetFieldID(htmlIteratorClass, "nativeHandle", "J");
+
+        environment->DeleteLocalRef(callbackClass);
+        environment->DeleteLocalRef(callbackFactoryClass);
+        environment->DeleteLocalRef(eventBatchDecoderClass);
+        environment->DeleteLocalRef(selectorCallbackClass);
+        environment->DeleteLocalRef(htmlIteratorClass);
+
+        bool isLoaded = tagInfoConstructor != nullptr && tagInfoNativeTag != nullptr
+                        && hashMapConstructor != nullptr
+                        && hashMapPut != nullptr && arrayListConstructor != nullptr
+                        && arrayListAdd != nullptr && onContentText != nullptr
+                        && onSingleTag != nullptr && onPairTag != nullptr
+                        && onLeavingPairTag != nullptr && onScript != nullptr
+                        && createCallback != nullptr && onEvents != nullptr
+                        && onMatch != nullptr && nativeHandle != nullptr;
+        if (!isLoaded) {
+            platformUtils::log("JniCache", "Unable to resolve java methods", ANDROID_LOG_ERROR);
+        }
+        return isLoaded;
+    }
+}
+
+#endif //ANDROID_HTML_ITERATOR_JNICACHE_H
@@ -0,0 +1,376 @@
+#include <jni.h>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "JniCache.h"
+#include "JniHtmlIteratorCallback.h"
+
+#ifndef ANDROID_HTML_ITERATOR_JNIEVENTBATCHCALLBACK_H
+#define ANDROID_HTML_ITERATOR_JNIEVENTBATCHCALLBACK_H
+
+
+/**
+ * Delivers results into kotlin EventBatchDecoder in batches instead of calling java for every
+ * result. Results are written as events into reusable direct ByteBuffer and whole batch is passed to
+ * java by single call of <code>onEvents</code> when <code>maxEventsCount</code> events are written
+ * or when <code>flush</code> is called. Layout of events has to match EventBatchDecoder.kt.
+ * <br>
+ * Every value is int32 or int64 in native byte order, events and strings are aligned to 4 bytes.
+ * Strings are written as length followed by code units of the content, so UTF-16 for char16_t and
+ * UTF-8 for char. Tag names and attribute names are written once per batch by STRING event and
+ * referenced by index in the table of the batch.
+ * <ul>
+ * <li>STRING: string, next entry of the table</li>
+ * <li>TEXT: string</li>
+ * <li>LEFT_PAIR_TAG_TEXT: string, text at the end of pair tag left by previous LEAVING_PAIR_TAG</li>
+ * <li>SINGLE_TAG, SCRIPT: tag</li>
+ * <li>PAIR_TAG: tag, int64 opening start, opening end, closing start, closing end</li>
+ * <li>LEAVING_PAIR_TAG: int64 closing start, closing end</li>
+ * </ul>
+ * Tag is int32 index of the name, int32 isSingle, string body, int32 count of attributes followed by
+ * pairs of int32 name index and string value, int32 count of classes followed by class strings.
+ * <br>
+ * Kotlin callback can't answer <code>onPairTag</code> from here, so content of every pair tag is
+ * iterated and decoder drops events of tags refused by the callback, including LEFT_PAIR_TAG_TEXT
+ * of the tag delivered right after its LEAVING_PAIR_TAG.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class JniEventBatchCallback : public JniHtmlIteratorCallback<CharT> {
+
+public:
+    using TagInfo = BasicTagInfo<CharT>;
+    using String = std::basic_string<CharT>;
+    using StringView = std::basic_string_view<CharT>;
+
+
+    /**
+     * Types of events, values must match EventBatchDecoder.kt.
+     * @since 1.0.0
+     */
+    enum EventType : int32_t {
+        STRING = 0,
+        TEXT = 1,
+        SINGLE_TAG = 2,
+        PAIR_TAG = 3,
+        LEAVING_PAIR_TAG = 4,
+        SCRIPT = 5,
+        LEFT_PAIR_TAG_TEXT = 6,
+    };
+
+
+    /**
+     * Flags of the batch passed to <code>onEvents</code>, values must match EventBatchDecoder.kt.
+     * @since 1.0.0
+     */
+    enum BatchFlag : jint {
+        UTF_16 = 1,
+
+        /**
+         * Batch is the first one of new content, decoder drops its state of previous content.
+         */
+        NEW_CONTENT = 2,
+    };
+
+
+private:
+
+    /**
+     * Batch is delivered when this count of events is written.
+     * @since 1.0.0
+     */
+    size_t maxEventsCount;
+
+    size_t eventsCount = 0;
+
+
+    /**
+     * Memory of events, only first <code>length</code> bytes are written. Grows when event doesn't
+     * fit and it's never shrunk, so it's reused by all batches.
+     * @since 1.0.0
+     */
+    std::vector<uint8_t> buffer;
+
+    size_t length = 0;
+
+
+    /**
+     * Global reference to direct ByteBuffer wrapping <code>buffer</code>, created again only when
+     * <code>buffer</code> grows.
+     * @since 1.0.0
+     */
+    jobject bufferRef = nullptr;
+
+    const uint8_t *bufferRefAddress = nullptr;
+    size_t bufferRefSize = 0;
+
+
+    /**
+     * Table of strings of current batch, maps string to its index.
+     * @since 1.0.0
+     */
+    std::unordered_map<String, int32_t> strings;
+
+
+    /**
+     * Indexes of attribute names of tag being written, reused by all tags.
+     * @since 1.0.0
+     */
+    std::vector<int32_t> attributeNameIndexes;
+
+
+    bool isNewContent = true;
+
+
+public:
+    JniEventBatchCallback(
+            JNIEnv *environment,
+            jobject decoder,
+            size_t maxEventsCount
+    ) : JniHtmlIteratorCallback<CharT>(environment, decoder) {
+        this->maxEventsCount = maxEventsCount > 0 ? maxEventsCount : 1;
+        this->buffer.resize(16 * 1024);
+    }
+
+
+    ~JniEventBatchCallback() override {
+        if (bufferRef != nullptr) {
+            this->environment->DeleteGlobalRef(bufferRef);
+        }
+    }
+
+
+    void onContentText(std::basic_string<CharT> &text) override {
+        if (this->environment->ExceptionCheck()) {
+            return;
+        }
+        writeInt(TEXT);
+        writeString(text);
+        onEventWritten();
+    }
+
+
+    void onLeftPairTagText(
+            std::basic_string<CharT> &text,
+            TagInfo &tag
+    ) override {
+        if (this->environment->ExceptionCheck()) {
+            return;
+        }
+        writeInt(LEFT_PAIR_TAG_TEXT);
+        writeString(text);
+        onEventWritten();
+    }
+
+
+    void onSingleTag(TagInfo &tag) override {
+        if (this->environment->ExceptionCheck()) {
+            return;
+        }
+        writeTagEvent(SINGLE_TAG, tag);
+        onEventWritten();
+    }
+
+
+    bool onPairTag(
+            TagInfo &tag,
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        //Content is skipped, nothing will be delivered until exception is handled in java
+        if (this->environment->ExceptionCheck()) {
+            return false;
+        }
+        writeTagEvent(PAIR_TAG, tag);
+        writeLong(this->toJavaIndex(openingTagStartIndex));
+        writeLong(this->toJavaIndex(openingTagEndIndex));
+        writeLong(this->toJavaIndex(closingTagStartIndex));
+        writeLong(this->toJavaIndex(closingTagEndIndex));
+        onEventWritten();
+        return true;
+    }
+
+
+    void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        if (this->environment->ExceptionCheck()) {
+            return;
+        }
+        writeInt(LEAVING_PAIR_TAG);
+        writeLong(this->toJavaIndex(closingTagStartIndex));
+        writeLong(this->toJavaIndex(closingTagEndIndex));
+        onEventWritten();
+    }
+
+
+    void onScript(TagInfo &tag) override {
+        if (this->environment->ExceptionCheck()) {
+            return;
+        }
+        writeTagEvent(SCRIPT, tag);
+        onEventWritten();
+    }
+
+
+    /**
+     * Delivers written events to java by single call, nothing is called when there are no events.
+     * @since 1.0.0
+     */
+    void flush() override {
+        if (eventsCount == 0) {
+            return;
+        }
+        if (this->environment->ExceptionCheck()) {
+            clearBatch();
+            return;
+        }
+        if (bufferRefAddress != buffer.data() || bufferRefSize != buffer.size()) {
+            if (bufferRef != nullptr) {
+                this->environment->DeleteGlobalRef(bufferRef);
+            }
+            jobject localBuffer = this->environment->NewDirectByteBuffer(
+                    buffer.data(),
+                    static_cast<jlong>(buffer.size())
+            );
+            bufferRef = this->environment->NewGlobalRef(localBuffer);
+            bufferRefAddress = buffer.data();
+            bufferRefSize = buffer.size();
+            this->environment->DeleteLocalRef(localBuffer);
+        }
+
+        jint flags = 0;
+        if constexpr (std::is_same_v<CharT, char16_t>) {
+            flags |= UTF_16;
+        }
+        if (isNewContent) {
+            flags |= NEW_CONTENT;
+        }
+        this->environment->CallVoidMethod(
+                this->callbackRef,
+                jniCache::onEvents,
+                bufferRef,
+                static_cast<jint>(length),
+                flags
+        );
+        isNewContent = false;
+        clearBatch();
+    }
+
+
+    /**
+     * Drops events which were not delivered yet, next batch tells decoder to drop its state too.
+     * @since 1.0.0
+     */
+    void reset() override {
+        clearBatch();
+        isNewContent = true;
+    }
+
+
+private:
+
+    void onEventWritten() {
+        eventsCount += 1;
+        if (eventsCount >= maxEventsCount) {
+            flush();
+        }
+    }
+
+
+    void clearBatch() {
+        eventsCount = 0;
+        length = 0;
+        strings.clear();
+    }
+
+
+    /**
+     * Writes tag of the event, names are added to the table by STRING events written before the
+     * event itself.
+     * @since 1.0.0
+     */
+    void writeTagEvent(EventType type, TagInfo &tag) {
+        int32_t nameIndex = getStringIndex(tag.getTag());
+        attributeNameIndexes.clear();
+        for (const auto &[name, value]: tag.getOutMap()) {
+            attributeNameIndexes.push_back(getStringIndex(name));
+        }
+
+        writeInt(type);
+        writeInt(nameIndex);
+        writeInt(tag.isSingleTag() ? 1 : 0);
+        writeString(tag.getBody());
+        writeInt(static_cast<int32_t>(attributeNameIndexes.size()));
+        size_t i = 0;
+        for (const auto &[name, value]: tag.getOutMap()) {
+            writeInt(attributeNameIndexes[i]);
+            writeString(value);
+            i += 1;
+        }
+        const auto &classes = tag.getClasses();
+        writeInt(static_cast<int32_t>(classes.size()));
+        for (const StringView &clazz: classes) {
+            writeString(clazz);
+        }
+    }
+
+
+    /**
+     * @return Index of the string in the table of the batch, string is added by STRING event when
+     * it's not there yet.
+     * @since 1.0.0
+     */
+    int32_t getStringIndex(const StringView &string) {
+        auto result = strings.try_emplace(String(string), static_cast<int32_t>(strings.size()));
+        if (result.second) {
+            writeInt(STRING);
+            writeString(string);
+        }
+        return result.first->second;
+    }
+
+
+    /**
+     * @return Pointer to <code>size</code> bytes at the end of written events, buffer grows when
+     * they don't fit.
+     * @since 1.0.0
+     */
+    uint8_t *reserve(size_t size) {
+        if (length + size > buffer.size()) {
+            buffer.resize(std::max(buffer.size() * 2, length + size));
+        }
+        uint8_t *destination = buffer.data() + length;
+        length += size;
+        return destination;
+    }
+
+
+    void writeInt(int32_t value) {
+        std::memcpy(reserve(sizeof(value)), &value, sizeof(value));
+    }
+
+
+    void writeLong(int64_t value) {
+        std::memcpy(reserve(sizeof(value)), &value, sizeof(value));
+    }
+
+
+    void writeString(const StringView &string) {
+        writeInt(static_cast<int32_t>(string.length()));
+        size_t size = string.length() * sizeof(CharT);
+        //Padding keeps next value aligned
+        size_t alignedSize = (size + 3) & ~static_cast<size_t>(3);
+        uint8_t *destination = reserve(alignedSize);
+        if (size > 0) {
+            std::memcpy(destination, string.data(), size);
+        }
+        std::memset(destination + size, 0, alignedSize - size);
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_JNIEVENTBATCHCALLBACK_H
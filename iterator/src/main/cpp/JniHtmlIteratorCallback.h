@@ -3,21 +3,30 @@
 ///
 
 #include <jni.h>
+#include <stack>
 #include "HtmlIteratorCallback.h"
-#include <codecvt>
-#include <locale>
+#include "JniCache.h"
+#include "JniTagInfo.h"
 
 #ifndef ANDROID_HTML_ITERATOR_JNIHTMLITERATORCALLBACK_H
 #define ANDROID_HTML_ITERATOR_JNIHTMLITERATORCALLBACK_H
 
 
 /**
- *
+ * Delivers results into kotlin HtmlIterator#Callback. Text of UTF-16 content (char16_t) is passed
+ * to java as it is, text of UTF-8 content (char) is decoded to UTF-16 by jniTagInfo::newString. Tags
+ * are passed as kotlin TagInfo backed by native tag, see jniTagInfo. Classes and methods are taken
+ * from <code>jniCache</code>, so no lookup is made per callback.
  */
-//TODO try preload global preferences for performance
-class JniHtmlIteratorCallback : public HtmlIteratorCallback {
+template<typename CharT>
+class JniHtmlIteratorCallback : public BasicHtmlIteratorCallback<CharT> {
+
+public:
+    using TagInfo = BasicTagInfo<CharT>;
+    using StringView = std::basic_string_view<CharT>;
 
-private:
+
+protected:
 
     /**
      * Jni environment used to call kotlin methods.
@@ -34,9 +43,12 @@ private:
     jobject callbackRef;
 
 
+private:
+
     /**
-     * Stack of instances of Tag info on java side. Every jobject in stack is global reference and
-     * needs to be deleted after leavingPairTag is called.
+     * Stack of instances of Tag info on java side. Every jobject in stack is global reference
+     * pointing to native tag in tagStack of the iterator, it needs to be invalidated and deleted
+     * after leavingPairTag is called.
      * @since 1.0.0
      */
     std::stack<jobject> kotlinTagInfoStack = std::stack<jobject>();
@@ -52,29 +64,55 @@ public:
         this->callbackRef = environment->NewGlobalRef(callback);
     }
 
-    ~JniHtmlIteratorCallback() {
+    /**
+     * Deletes global reference to kotlin callback, so environment must be valid for calling thread.
+     * @since 1.0.0
+     */
+    ~JniHtmlIteratorCallback() override {
+        releaseKotlinTagInfos();
+        environment->DeleteGlobalRef(callbackRef);
         environment = nullptr;
     }
 
 
-    void onContentText(std::string &text) override {
-        jmethodID methodId = environment->GetMethodID(
-                environment->FindClass("com/htmliterator/HtmlIterator$Callback"),
-                "onContentText",
-                "(Ljava/lang/String;)V"
-        );
+    /**
+     * Sets environment of calling thread. JNIEnv is valid only within thread it belongs to, so it
+     * has to be updated before every iteration, iterator may be used from another thread than the
+     * one which set the callback.
+     * @param environment Environment of calling thread.
+     * @since 1.0.0
+     */
+    void setEnvironment(JNIEnv *environment) {
+        this->environment = environment;
+    }
+
+
+    /**
+     * Delivers results held back by the callback, must be called when iteration returns to java.
+     * Results are delivered immediately here, see JniEventBatchCallback.
+     * @since 1.0.0
+     */
+    virtual void flush() {
+    }
+
+
+    /**
+     * Drops state of previous content, must be called when iterator gets new content. Tag infos of
+     * pair tags which were not left yet are released.
+     * @since 1.0.0
+     */
+    virtual void reset() {
+        releaseKotlinTagInfos();
+    }
 
 
-        if (methodId == nullptr) {
-            platformUtils::log(
-                    "Unable to find method 'onContentText' in kotlin callback class.",
-                    ANDROID_LOG_ERROR
-            );
+    void onContentText(std::basic_string<CharT> &text) override {
+        //Java must not be called while exception thrown by previous callback is pending
+        if (environment->ExceptionCheck()) {
             return;
         }
-
-        jstring jText = environment->NewStringUTF(text.c_str());
-        environment->CallVoidMethod(callbackRef, methodId, jText);
+        jstring jText = jniTagInfo::newString<CharT>(environment, text);
+        environment->CallVoidMethod(callbackRef, jniCache::onContentText, jText);
         environment->DeleteLocalRef(jText);
     }
 
@@ -82,26 +120,18 @@ public:
     /**
      *
      * @param tag
-     * @throw std::runtime_error if method 'onSingleTag' is not found in kotlin callback class or when
-     * 'TagInfo' could not be constructed in java.
      */
     void onSingleTag(TagInfo &tag) override {
-        jmethodID methodId = environment->GetMethodID(
-                environment->GetObjectClass(callbackRef),
-                "onSingleTag",
-                "(Lcom/htmliterator/TagInfo;)V"
-        );
-
-        if (methodId == nullptr) {
-            std::string errorMessage = "Unable to find method 'onSingleTag' in kotlin callback class.";
-            platformUtils::log(errorMessage, ANDROID_LOG_ERROR);
-            throw std::runtime_error(errorMessage);
+        //Java must not be called while exception thrown by previous callback is pending
+        if (environment->ExceptionCheck()) {
+            return;
         }
+        //Native tag lives only within this call, so local reference is enough
+        jobject tagInfoKotlin = jniTagInfo::newKotlinTagInfo(environment, tag);
 
-        jobject tagInfoKotlin = createKotlinTagInfo(tag);
-
-        environment->CallVoidMethod(callbackRef, methodId, tagInfoKotlin);
-        environment->DeleteGlobalRef(tagInfoKotlin);
+        environment->CallVoidMethod(callbackRef, jniCache::onSingleTag, tagInfoKotlin);
+        jniTagInfo::invalidate(environment, tagInfoKotlin);
+        environment->DeleteLocalRef(tagInfoKotlin);
 
     }
 
@@ -113,40 +143,35 @@ public:
      * @param closingTagStartIndex
      * @param closingTagEndIndex
      * @return
-     * @throw std::runtime_error if method 'onPairTag' is not found in kotlin callback class or when
-     * 'TagInfo' could not be constructed in java.
      * @since 1.0.0
      */
     bool onPairTag(
             TagInfo &tag,
-            size_t openingTagStartIndex,
-            size_t openingTagEndIndex,
-            size_t closingTagStartIndex,
-            size_t closingTagEndIndex
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
     ) override {
-        jmethodID methodId = environment->GetMethodID(
-                environment->GetObjectClass(callbackRef),
-                "onPairTag",
-                "(Lcom/htmliterator/TagInfo;IIII)Z"
-        );
-
-        if (methodId == nullptr) {
-            std::string errorMesssage = "Unable to find method 'onPairTag' in kotlin callback class.";
-            platformUtils::log(errorMesssage, ANDROID_LOG_ERROR);
-            throw std::runtime_error(errorMesssage);
+        //Java must not be called while exception thrown by previous callback is pending
+        if (environment->ExceptionCheck()) {
+            //Keeps the stack balanced for onLeavingPairTag, content of the tag is skipped
+            kotlinTagInfoStack.push(nullptr);
+            return false;
         }
-
-        jobject tagInfoKotlin = createKotlinTagInfo(tag);
+        //Native tag stays in tagStack of the iterator until the tag is left
+        jobject localTagInfoKotlin = jniTagInfo::newKotlinTagInfo(environment, tag);
+        jobject tagInfoKotlin = environment->NewGlobalRef(localTagInfoKotlin);
+        environment->DeleteLocalRef(localTagInfoKotlin);
         kotlinTagInfoStack.push(tagInfoKotlin);
         //TODO maybe remove, not necessary for the library
-        jint jOpeningTagStartIndex = static_cast<jint>(openingTagEndIndex);
-        jint jOpeningTagEndIndex = static_cast<jint>(openingTagEndIndex);
-        jint jClosingTagStartIndex = static_cast<jint>(closingTagStartIndex);
-        jint jClosingTagEndIndex = static_cast<jint>(closingTagEndIndex);
+        jlong jOpeningTagStartIndex = toJavaIndex(openingTagStartIndex);
+        jlong jOpeningTagEndIndex = toJavaIndex(openingTagEndIndex);
+        jlong jClosingTagStartIndex = toJavaIndex(closingTagStartIndex);
+        jlong jClosingTagEndIndex = toJavaIndex(closingTagEndIndex);
 
         jboolean result = environment->CallBooleanMethod(
                 callbackRef,
-                methodId,
+                jniCache::onPairTag,
                 tagInfoKotlin,
                 jOpeningTagStartIndex,
                 jOpeningTagEndIndex,
@@ -161,143 +186,74 @@ public:
     /**
      *
      * @param tag
-     * @throw std::runtime_error if method 'onLeavingPairTag' is not found in kotlin callback class
+     * @param closingTagStartIndex
+     * @param closingTagEndIndex
      * @since 1.0.0
      */
-    void onLeavingPairTag(TagInfo &tag) override {
-        jmethodID methodId = environment->GetMethodID(
-                environment->GetObjectClass(callbackRef),
-                "onLeavingPairTag",
-                "(Lcom/htmliterator/TagInfo;)V"
-        );
-
-        if (methodId == nullptr) {
-            std::string errorMessage = "Unable to find method 'onLeavingPairTag' in kotlin callback class.";
-            platformUtils::log(errorMessage, ANDROID_LOG_ERROR);
-            throw std::runtime_error(errorMessage);
+    void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        if (environment->ExceptionCheck()) {
+            //Tag info still has to be released
+            jniTagInfo::invalidate(environment, kotlinTagInfoStack.top());
+            environment->DeleteGlobalRef(kotlinTagInfoStack.top());
+            kotlinTagInfoStack.pop();
+            return;
         }
-
         jobject tagInfoKotlin = kotlinTagInfoStack.top();
-        environment->CallVoidMethod(callbackRef, methodId, tagInfoKotlin);
+        environment->CallVoidMethod(
+                callbackRef,
+                jniCache::onLeavingPairTag,
+                tagInfoKotlin,
+                toJavaIndex(closingTagStartIndex),
+                toJavaIndex(closingTagEndIndex)
+        );
+        jniTagInfo::invalidate(environment, tagInfoKotlin);
         environment->DeleteGlobalRef(tagInfoKotlin);
         kotlinTagInfoStack.pop();
     }
 
 
     void onScript(TagInfo &tag) override {
-        jmethodID methodId = environment->GetMethodID(
-                environment->GetObjectClass(callbackRef),
-                "onScript",
-                "(Lcom/htmliterator/TagInfo;)V"
-        );
-        if (methodId == nullptr) {
-            platformUtils::log(
-                    "Unable to find method 'onScript' in kotlin callback class.",
-                    ANDROID_LOG_ERROR
-            );
+        //Java must not be called while exception thrown by previous callback is pending
+        if (environment->ExceptionCheck()) {
+            return;
         }
-        jobject tagInfoKotlin = createKotlinTagInfo(tag);
+        jobject tagInfoKotlin = jniTagInfo::newKotlinTagInfo(environment, tag);
 
-        environment->CallVoidMethod(callbackRef, methodId, tagInfoKotlin);
-        environment->DeleteGlobalRef(tagInfoKotlin);
+        environment->CallVoidMethod(callbackRef, jniCache::onScript, tagInfoKotlin);
+        jniTagInfo::invalidate(environment, tagInfoKotlin);
+        environment->DeleteLocalRef(tagInfoKotlin);
     }
 
 private:
 
     /**
-     *
-     * @param tagInfo
-     * @return jobject if TagInfo was constructed onc java code successfully, nullptr otherwise
+     * Invalidates and deletes all kotlin tag infos of pair tags which were not left.
      * @since 1.0.0
      */
-    jobject createKotlinTagInfo(TagInfo &tagInfo) {
-        // Find the Kotlin TagInfo class
-        jclass tagInfoClass = environment->FindClass("com/htmliterator/TagInfo");
-        if (!tagInfoClass) {
-            return nullptr; // Handle error
-        }
-
-        // Find the Kotlin TagInfo constructor
-        jmethodID constructor = environment->GetMethodID(
-                tagInfoClass,
-                "<init>",
-                "(Ljava/lang/String;Ljava/lang/String;Ljava/util/Map;Ljava/util/List;Z)V"
-        );
-        if (!constructor) {
-            std::string errorMessage =
-                    "Error creating Kotlin TagInfo object, unable to find constructor in java!! "
-                    "Check createKotlinTagInfo() method implementation.";
-            platformUtils::log(errorMessage, ANDROID_LOG_ERROR);
-            throw std::runtime_error(errorMessage);
-
-        }
-
-        // Convert C++ fields to JNI types
-        jstring tag = environment->NewStringUTF(tagInfo.getTag().c_str());
-        jstring body = environment->NewStringUTF(tagInfo.getBody().c_str());
-
-        // Convert attributes (std::map<std::string, std::string>) to Java Map
-        jclass hashMapClass = environment->FindClass("java/util/HashMap");
-        jmethodID hashMapConstructor = environment->GetMethodID(
-                hashMapClass,
-                "<init>",
-                "()V"
-        );
-        jobject hashMap = environment->NewObject(hashMapClass, hashMapConstructor);
-
-        jmethodID putMethod = environment->GetMethodID(
-                hashMapClass,
-                "put",
-                "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;"
-        );
-
-
-        for (const auto &[key, value]: tagInfo.getOutMap()) {
-            jstring jKey = environment->NewStringUTF(key.c_str());
-            jstring jValue = environment->NewStringUTF(value.c_str());
-
-            environment->CallObjectMethod(hashMap, putMethod, jKey, jValue);
-            //    environment->DeleteLocalRef(jKey);
-            //   environment->DeleteLocalRef(jValue);
-
+    void releaseKotlinTagInfos() {
+        while (!kotlinTagInfoStack.empty()) {
+            jniTagInfo::invalidate(environment, kotlinTagInfoStack.top());
+            environment->DeleteGlobalRef(kotlinTagInfoStack.top());
+            kotlinTagInfoStack.pop();
         }
+    }
 
-        // Convert clazz (std::vector<std::string_view>) to Java List
-        jclass arrayListClass = environment->FindClass("java/util/ArrayList");
-        jmethodID arrayListConstructor = environment->GetMethodID(
-                arrayListClass,
-                "<init>",
-                "()V"
-        );
-        jobject arrayList = environment->NewObject(
-                arrayListClass,
-                arrayListConstructor
-        );
-
-        jmethodID addMethod = environment->GetMethodID(
-                arrayListClass,
-                "add",
-                "(Ljava/lang/Object;)Z"
-        );
 
-        for (const auto &cls: tagInfo.getClasses()) {
-            jstring tagClass = environment->NewStringUTF(cls.data());
-            environment->CallBooleanMethod(arrayList, addMethod, tagClass);
-            //   environment->DeleteLocalRef(tagClass);
-        }
+protected:
 
-        // Create the Kotlin TagInfo object
-        jobject kotlinTagInfo = environment->NewObject(
-                tagInfoClass,
-                constructor,
-                tag,
-                body,
-                hashMap,
-                arrayList,
-                static_cast<jboolean>( tagInfo.isSingleTag())
-        );
-
-        return environment->NewGlobalRef(kotlinTagInfo);
+    /**
+     * Converts index within the input to java long, so inputs bigger than <code>jint</code> can be
+     * indexed.
+     * @param index Index within the input or <code>UINT64_MAX</code> when index is not known.
+     * @return Index as jlong, -1 when index is not known.
+     * @since 1.0.0
+     */
+    static jlong toJavaIndex(uint64_t index) {
+        return index != UINT64_MAX ? static_cast<jlong>(index) : -1;
     }
 };
 
@@ -0,0 +1,112 @@
+#include <jni.h>
+#include <vector>
+#include "JniCache.h"
+#include "JniHtmlIteratorCallback.h"
+#include "JniTagInfo.h"
+#include "SelectorMatcher.h"
+
+#ifndef ANDROID_HTML_ITERATOR_JNISELECTORCALLBACK_H
+#define ANDROID_HTML_ITERATOR_JNISELECTORCALLBACK_H
+
+
+/**
+ * Matches selectors natively and delivers only matching elements into kotlin
+ * HtmlIterator#SelectorCallback, so other results never cross into java. Tag passed to
+ * <code>onMatch</code> is valid only within the call, see jniTagInfo.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class JniSelectorCallback : public JniHtmlIteratorCallback<CharT>, public BasicSelectorCallback<CharT> {
+
+public:
+    using TagInfo = BasicTagInfo<CharT>;
+    using Selector = BasicCssSelector<CharT>;
+
+
+private:
+    BasicSelectorMatcher<CharT> matcher;
+
+
+public:
+    JniSelectorCallback(
+            JNIEnv *environment,
+            jobject selectorCallback,
+            std::vector<Selector> &&selectors
+    ) : JniHtmlIteratorCallback<CharT>(environment, selectorCallback),
+        matcher(std::move(selectors), this) {
+    }
+
+
+    void reset() override {
+        JniHtmlIteratorCallback<CharT>::reset();
+        matcher.clear();
+    }
+
+
+    void onContentText(std::basic_string<CharT> &text) override {
+    }
+
+
+    void onSingleTag(TagInfo &tag) override {
+        matcher.onSingleTag(tag);
+    }
+
+
+    void onScript(TagInfo &tag) override {
+        matcher.onScript(tag);
+    }
+
+
+    bool onPairTag(
+            TagInfo &tag,
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        matcher.onPairTag(
+                tag,
+                openingTagStartIndex,
+                openingTagEndIndex,
+                closingTagStartIndex,
+                closingTagEndIndex
+        );
+        //Content is skipped, nothing will be delivered until exception is handled in java
+        return !this->environment->ExceptionCheck();
+    }
+
+
+    void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        matcher.onLeavingPairTag(tag, closingTagStartIndex, closingTagEndIndex);
+    }
+
+
+    void onMatch(
+            TagInfo &tag,
+            size_t selectorIndex,
+            uint64_t contentStartIndex,
+            uint64_t contentEndIndex
+    ) override {
+        //Java must not be called while exception thrown by previous callback is pending
+        if (this->environment->ExceptionCheck()) {
+            return;
+        }
+        jobject tagInfoKotlin = jniTagInfo::newKotlinTagInfo(this->environment, tag);
+        this->environment->CallVoidMethod(
+                this->callbackRef,
+                jniCache::onMatch,
+                tagInfoKotlin,
+                static_cast<jint>(selectorIndex),
+                this->toJavaIndex(contentStartIndex),
+                this->toJavaIndex(contentEndIndex)
+        );
+        jniTagInfo::invalidate(this->environment, tagInfoKotlin);
+        this->environment->DeleteLocalRef(tagInfoKotlin);
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_JNISELECTORCALLBACK_H
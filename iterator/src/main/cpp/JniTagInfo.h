@@ -0,0 +1,216 @@
+#include <jni.h>
+#include <string>
+#include <type_traits>
+#include "JniCache.h"
+#include "TagInfo.h"
+
+#ifndef ANDROID_HTML_ITERATOR_JNITAGINFO_H
+#define ANDROID_HTML_ITERATOR_JNITAGINFO_H
+
+
+/**
+ * Kotlin TagInfo backed by native BasicTagInfo. Kotlin tag holds pointer to native tag and creates
+ * its values by getters below only when they are read, so tags whose values are never read cost
+ * single object. Pointer is valid only while the native tag is delivered, it's cleared by
+ * <code>invalidate</code> before the native tag goes away.
+ * @since 1.0.0
+ */
+namespace jniTagInfo {
+
+
+    /**
+     * Decodes UTF-8 text into UTF-16 <code>output</code>. Content is not validated by iterator, so
+     * every invalid or truncated sequence is replaced by U+FFFD, the same way as java decodes UTF-8.
+     * @since 1.0.0
+     */
+    inline void decodeUtf8(std::string_view text, std::u16string &output) {
+        output.clear();
+        output.reserve(text.length());
+        const size_t length = text.length();
+        size_t index = 0;
+        while (index < length) {
+            auto byte = static_cast<unsigned char>(text[index++]);
+            if (byte < 0x80) {
+                output.push_back(byte);
+                continue;
+            }
+            size_t count;
+            char32_t codePoint;
+            //Range of the second byte, excludes overlong forms, surrogates and values above U+10FFFF
+            unsigned char lower = 0x80;
+            unsigned char upper = 0xBF;
+            if (byte >= 0xC2 && byte <= 0xDF) {
+                count = 1;
+                codePoint = byte & 0x1F;
+            } else if (byte >= 0xE0 && byte <= 0xEF) {
+                count = 2;
+                codePoint = byte & 0x0F;
+                if (byte == 0xE0) {
+                    lower = 0xA0;
+                } else if (byte == 0xED) {
+                    upper = 0x9F;
+                }
+            } else if (byte >= 0xF0 && byte <= 0xF4) {
+                count = 3;
+                codePoint = byte & 0x07;
+                if (byte == 0xF0) {
+                    lower = 0x90;
+                } else if (byte == 0xF4) {
+                    upper = 0x8F;
+                }
+            } else {
+                output.push_back(u'\uFFFD');
+                continue;
+            }
+
+            size_t read = 0;
+            while (read < count && index < length) {
+                auto next = static_cast<unsigned char>(text[index]);
+                if (next < lower || next > upper) {
+                    break;
+                }
+                codePoint = (codePoint << 6) | (next & 0x3F);
+                lower = 0x80;
+                upper = 0xBF;
+                index++;
+                read++;
+            }
+
+            if (read < count) {
+                //Byte breaking the sequence is decoded again as start of the next one
+                output.push_back(u'\uFFFD');
+            } else if (codePoint >= 0x10000) {
+                codePoint -= 0x10000;
+                output.push_back(static_cast<char16_t>(0xD800 + (codePoint >> 10)));
+                output.push_back(static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF)));
+            } else {
+                output.push_back(static_cast<char16_t>(codePoint));
+            }
+        }
+    }
+
+
+    /**
+     * Creates java string from view. UTF-16 views are passed directly to NewString. UTF-8 views are
+     * decoded into buffer of the thread first by decodeUtf8, NewStringUTF expects modified UTF-8 and
+     * it's not safe for content which is not valid UTF-8.
+     * @return New local reference to java string.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    jstring newString(JNIEnv *environment, const std::basic_string_view<CharT> &text) {
+        if constexpr (std::is_same_v<CharT, char16_t>) {
+            return environment->NewString(
+                    reinterpret_cast<const jchar *>(text.data()),
+                    static_cast<jsize>(text.length())
+            );
+        } else {
+            thread_local std::u16string buffer;
+            decodeUtf8(text, buffer);
+            return environment->NewString(
+                    reinterpret_cast<const jchar *>(buffer.data()),
+                    static_cast<jsize>(buffer.length())
+            );
+        }
+    }
+
+
+    /**
+     * @return New local reference to java HashMap with attributes of the tag.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    jobject newAttributes(JNIEnv *environment, const BasicTagInfo<CharT> &tag) {
+        jobject hashMap = environment->NewObject(
+                jniCache::hashMapClass,
+                jniCache::hashMapConstructor
+        );
+        for (const auto &[key, value]: tag.getOutMap()) {
+            jstring jKey = newString(environment, key);
+            jstring jValue = newString(environment, value);
+            jobject previous = environment->CallObjectMethod(hashMap, jniCache::hashMapPut, jKey, jValue);
+            environment->DeleteLocalRef(previous);
+            environment->DeleteLocalRef(jKey);
+            environment->DeleteLocalRef(jValue);
+        }
+        return hashMap;
+    }
+
+
+    /**
+     * @return New local reference to java ArrayList with classes of the tag.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    jobject newClasses(JNIEnv *environment, const BasicTagInfo<CharT> &tag) {
+        jobject arrayList = environment->NewObject(
+                jniCache::arrayListClass,
+                jniCache::arrayListConstructor
+        );
+        for (const auto &clazz: tag.getClasses()) {
+            jstring jClazz = newString(environment, clazz);
+            environment->CallBooleanMethod(arrayList, jniCache::arrayListAdd, jClazz);
+            environment->DeleteLocalRef(jClazz);
+        }
+        return arrayList;
+    }
+
+
+    /**
+     * Creates kotlin TagInfo pointing to the tag, tag must stay at its address until
+     * <code>invalidate</code> is called.
+     * @return New local reference to kotlin TagInfo.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    jobject newKotlinTagInfo(JNIEnv *environment, BasicTagInfo<CharT> &tag) {
+        return environment->NewObject(
+                jniCache::tagInfoClass,
+                jniCache::tagInfoConstructor,
+                reinterpret_cast<jlong>(&tag),
+                static_cast<jboolean>(std::is_same_v<CharT, char16_t>),
+                static_cast<jboolean>(tag.isSingleTag())
+        );
+    }
+
+
+    /**
+     * Clears pointer to native tag in kotlin TagInfo, values which were not read yet can't be read
+     * anymore. Works also while exception is pending, exception is thrown again after.
+     * @param kotlinTagInfo Kotlin TagInfo, may be nullptr.
+     * @since 1.0.0
+     */
+    void invalidate(JNIEnv *environment, jobject kotlinTagInfo) {
+        if (kotlinTagInfo == nullptr) {
+            return;
+        }
+        jthrowable exception = environment->ExceptionOccurred();
+        if (exception != nullptr) {
+            environment->ExceptionClear();
+        }
+        environment->SetLongField(kotlinTagInfo, jniCache::tagInfoNativeTag, 0);
+        if (exception != nullptr) {
+            environment->Throw(exception);
+            environment->DeleteLocalRef(exception);
+        }
+    }
+
+
+    /**
+     * Calls action with native tag of kotlin TagInfo.
+     * @param nativeTag Pointer to native tag.
+     * @param isUtf16 True when tag is <code>BasicTagInfo&lt;char16_t&gt;</code>.
+     * @param action Generic lambda accepting <code>BasicTagInfo</code> of any code unit type.
+     * @return Result of the action.
+     * @since 1.0.0
+     */
+    template<typename Action>
+    auto withNativeTag(jlong nativeTag, jboolean isUtf16, Action action) {
+        if (isUtf16) {
+            return action(*reinterpret_cast<BasicTagInfo<char16_t> *>(nativeTag));
+        }
+        return action(*reinterpret_cast<BasicTagInfo<char> *>(nativeTag));
+    }
+}
+
+#endif //ANDROID_HTML_ITERATOR_JNITAGINFO_H
@@ -0,0 +1,122 @@
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "PlatformUtils.h"
+
+#ifndef ANDROID_HTML_ITERATOR_MAPPEDFILE_H
+#define ANDROID_HTML_ITERATOR_MAPPEDFILE_H
+
+
+/**
+ * Read only memory mapping of a file. File is mapped with <code>MADV_SEQUENTIAL</code> advice as
+ * iterator reads content from start to end, so kernel can read ahead and drop pages behind. Content
+ * is never copied, pages are loaded from page cache on demand.
+ * @since 1.0.0
+ */
+class MappedFile {
+
+private:
+    void *address = nullptr;
+    size_t length = 0;
+
+
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+
+    ~MappedFile() {
+        close();
+    }
+
+
+    /**
+     * Maps file at path, previous mapping is closed.
+     * @param path Path to the file.
+     * @return True when file was mapped, false when it can't be opened or mapped.
+     * @since 1.0.0
+     */
+    bool open(const std::string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            platformUtils::log("MappedFile", "Unable to open file: " + path, ANDROID_LOG_ERROR);
+            return false;
+        }
+        bool isMapped = open(fd);
+        //Mapping keeps the file referenced, descriptor is no longer needed
+        ::close(fd);
+        return isMapped;
+    }
+
+
+    /**
+     * Maps file opened by fd from its start, previous mapping is closed. Descriptor stays owned by
+     * caller and can be closed right after the call.
+     * @param fd Descriptor of file opened for reading.
+     * @return True when file was mapped, false when it can't be mapped.
+     * @since 1.0.0
+     */
+    bool open(int fd) {
+        close();
+        struct stat fileStat{};
+        if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+            platformUtils::log("MappedFile", "Descriptor is not a regular file", ANDROID_LOG_ERROR);
+            return false;
+        }
+
+        auto fileLength = static_cast<uint64_t>(fileStat.st_size);
+        if (fileLength == 0) {
+            //Empty file can't be mapped, it's just empty content
+            return true;
+        }
+        if (fileLength > static_cast<uint64_t>(SIZE_MAX)) {
+            platformUtils::log("MappedFile", "File is too big for address space", ANDROID_LOG_ERROR);
+            return false;
+        }
+
+        void *newAddress = mmap(nullptr, fileLength, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (newAddress == MAP_FAILED) {
+            platformUtils::log("MappedFile", "Unable to map file", ANDROID_LOG_ERROR);
+            return false;
+        }
+        madvise(newAddress, fileLength, MADV_SEQUENTIAL);
+
+        this->address = newAddress;
+        this->length = static_cast<size_t>(fileLength);
+        return true;
+    }
+
+
+    /**
+     * Unmaps the file, views returned by <code>getContent</code> are no longer valid.
+     * @since 1.0.0
+     */
+    void close() {
+        if (this->address != nullptr) {
+            munmap(this->address, this->length);
+        }
+        this->address = nullptr;
+        this->length = 0;
+    }
+
+
+    /**
+     * @return Content of mapped file, empty when no file is mapped.
+     * @since 1.0.0
+     */
+    [[nodiscard]] std::string_view getContent() const {
+        if (this->address == nullptr) {
+            return {};
+        }
+        return {static_cast<const char *>(this->address), this->length};
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_MAPPEDFILE_H
@@ -2,13 +2,37 @@
 /// Created by Miroslav Hýbler on 22.11.2024
 ///
 
+#if defined(__ANDROID__)
 #include <android/log.h>
+#else
+#include <cstdio>
+#endif
 #include <string>
 
 #ifndef ANDROID_HTML_ITERATOR_PLATFORMUTILS_H
 #define ANDROID_HTML_ITERATOR_PLATFORMUTILS_H
 
 
+#if !defined(__ANDROID__)
+/**
+ * Priorities of android/log.h for host build of native tests, where messages are written into
+ * stderr.
+ * @since 1.0.0
+ */
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+} android_LogPriority;
+#endif
+
+
 /**
 * True when logging is enabled, false otherwise. Used for development and debugging only,
 * doesn't make sense to use logging in release mode.
@@ -50,12 +74,16 @@ namespace platformUtils {
         }
 #pragma clang diagnostic pop
 
+#if defined(__ANDROID__)
         __android_log_print(
                 priority,
                 tag,
                 "%s",
                 message.c_str()
         );
+#else
+        std::fprintf(stderr, "%s: %s\n", tag, message.c_str());
+#endif
     }
 
     /**
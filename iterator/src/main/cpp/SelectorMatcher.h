@@ -0,0 +1,198 @@
+#include <vector>
+#include "CssSelector.h"
+#include "HtmlIteratorCallback.h"
+
+#ifndef ANDROID_HTML_ITERATOR_SELECTORMATCHER_H
+#define ANDROID_HTML_ITERATOR_SELECTORMATCHER_H
+
+
+/**
+ * Callback of <code>BasicSelectorMatcher</code> getting elements matching selectors.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class BasicSelectorCallback {
+
+public:
+    using TagInfo = BasicTagInfo<CharT>;
+
+
+    virtual ~BasicSelectorCallback() = default;
+
+
+    /**
+     * Called when element matches selector. Pair tags are delivered when they are left, so their
+     * content range is known and nested matches are delivered before their ancestors. Single tags
+     * and scripts are delivered when they are found.
+     * @param tag Matching tag.
+     * @param selectorIndex Index of the matched selector.
+     * @param contentStartIndex Index of the first char of the content of the tag,
+     * <code>UINT64_MAX</code> for single tag.
+     * @param contentEndIndex Index right after the content of the tag, index of '<' of closing tag,
+     * <code>UINT64_MAX</code> for single tag.
+     * @since 1.0.0
+     */
+    virtual void onMatch(
+            TagInfo &tag,
+            size_t selectorIndex,
+            uint64_t contentStartIndex,
+            uint64_t contentEndIndex
+    ) = 0;
+};
+
+
+/**
+ * Matches selectors incrementally as iterator enters and leaves tags, so content is matched in
+ * single pass without building DOM. Matcher keeps its own stack of opened elements pointing to tags
+ * in <code>tagStack</code> of the iterator together with positions among siblings, every element is
+ * matched against all selectors once when it's entered.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class BasicSelectorMatcher : public BasicHtmlIteratorCallback<CharT> {
+
+public:
+    using TagInfo = BasicTagInfo<CharT>;
+    using Selector = BasicCssSelector<CharT>;
+    using Element = typename Selector::Element;
+    using Callback = BasicSelectorCallback<CharT>;
+
+
+private:
+    std::vector<Selector> selectors;
+    Callback *target;
+
+
+    /**
+     * Opened pair tags from the root, followed by single tag while it's matched.
+     * @since 1.0.0
+     */
+    std::vector<Element> elements;
+
+
+    /**
+     * Indexes of selectors matched by opened pair tags, delivered when the tag is left. Matches of
+     * element start at its index in <code>matchesStarts</code>.
+     * @since 1.0.0
+     */
+    std::vector<size_t> pendingMatches;
+    std::vector<size_t> matchesStarts;
+
+
+    /**
+     * Count of elements without parent, e.g. in clip of html content.
+     * @since 1.0.0
+     */
+    uint32_t rootChildrenCount = 0;
+
+
+public:
+    BasicSelectorMatcher(
+            std::vector<Selector> &&selectors,
+            Callback *target
+    ) : selectors(std::move(selectors)), target(target) {
+    }
+
+
+    /**
+     * Drops state of previous content, must be called when iterator gets new content.
+     * @since 1.0.0
+     */
+    void clear() {
+        elements.clear();
+        pendingMatches.clear();
+        matchesStarts.clear();
+        rootChildrenCount = 0;
+    }
+
+
+    void onContentText(std::basic_string<CharT> &text) override {
+    }
+
+
+    void onSingleTag(TagInfo &tag) override {
+        matchSingleElement(tag, UINT64_MAX, UINT64_MAX);
+    }
+
+
+    void onScript(TagInfo &tag) override {
+        matchSingleElement(tag, tag.getPairContentStartIndex(), tag.getPairContentEndIndex());
+    }
+
+
+    bool onPairTag(
+            TagInfo &tag,
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        elements.push_back({&tag, nextPosition(), 0});
+        matchesStarts.push_back(pendingMatches.size());
+        for (size_t i = 0; i < selectors.size(); i++) {
+            if (selectors[i].matches(elements)) {
+                pendingMatches.push_back(i);
+            }
+        }
+        return true;
+    }
+
+
+    void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        if (elements.empty()) {
+            return;
+        }
+        size_t matchesStart = matchesStarts.back();
+        for (size_t i = matchesStart; i < pendingMatches.size(); i++) {
+            target->onMatch(
+                    tag,
+                    pendingMatches[i],
+                    tag.getPairContentStartIndex(),
+                    tag.getPairContentEndIndex()
+            );
+        }
+        pendingMatches.resize(matchesStart);
+        matchesStarts.pop_back();
+        elements.pop_back();
+    }
+
+
+private:
+
+    /**
+     * @return Position of the next element among its siblings.
+     * @since 1.0.0
+     */
+    uint32_t nextPosition() {
+        uint32_t &childrenCount = elements.empty()
+                                  ? rootChildrenCount
+                                  : elements.back().childrenCount;
+        childrenCount += 1;
+        return childrenCount;
+    }
+
+
+    /**
+     * Matches element without content, which is never a parent, and delivers its matches right away.
+     * @since 1.0.0
+     */
+    void matchSingleElement(
+            TagInfo &tag,
+            uint64_t contentStartIndex,
+            uint64_t contentEndIndex
+    ) {
+        elements.push_back({&tag, nextPosition(), 0});
+        for (size_t i = 0; i < selectors.size(); i++) {
+            if (selectors[i].matches(elements)) {
+                target->onMatch(tag, i, contentStartIndex, contentEndIndex);
+            }
+        }
+        elements.pop_back();
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_SELECTORMATCHER_H
@@ -0,0 +1,103 @@
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HTML_ITERATOR_SIMD_SSE2 1
+#else
+#define HTML_ITERATOR_SIMD_SSE2 0
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTML_ITERATOR_SIMD_X86 1
+#else
+#define HTML_ITERATOR_SIMD_X86 0
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define HTML_ITERATOR_SIMD_NEON 1
+#else
+#define HTML_ITERATOR_SIMD_NEON 0
+#endif
+
+#ifndef ANDROID_HTML_ITERATOR_SIMDUTILS_H
+#define ANDROID_HTML_ITERATOR_SIMDUTILS_H
+
+
+/**
+ * Holds helpers for vectorized kernels shared across the library. Kernels are selected by
+ * HTML_ITERATOR_SIMD_* macros, every kernel must have scalar fallback for platforms without
+ * supported instruction set (e.g. armeabi-v7a).
+ * @since 1.0.0
+ */
+namespace simdUtils {
+
+#if HTML_ITERATOR_SIMD_SSE2
+
+    /**
+     * Loads 16 code units as 16 bytes.
+     * @since 1.0.0
+     */
+    __m128i load16(const char *input) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+    }
+
+
+    /**
+     * Loads 16 UTF-16 code units as 16 bytes. Units are narrowed with saturation, so units out of
+     * ASCII range never become ASCII bytes and can't be mistaken for structural or white chars.
+     * @since 1.0.0
+     */
+    __m128i load16(const char16_t *input) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + 8));
+        return _mm_packus_epi16(low, high);
+    }
+
+#endif
+
+#if HTML_ITERATOR_SIMD_NEON
+
+    /**
+     * Loads 16 code units as 16 bytes.
+     * @since 1.0.0
+     */
+    uint8x16_t load16(const char *input) {
+        return vld1q_u8(reinterpret_cast<const uint8_t *>(input));
+    }
+
+
+    /**
+     * Loads 16 UTF-16 code units as 16 bytes. Units are narrowed with saturation, so units out of
+     * ASCII range never become ASCII bytes and can't be mistaken for structural or white chars.
+     * @since 1.0.0
+     */
+    uint8x16_t load16(const char16_t *input) {
+        const auto *units = reinterpret_cast<const uint16_t *>(input);
+        return vcombine_u8(vqmovn_u16(vld1q_u16(units)), vqmovn_u16(vld1q_u16(units + 8)));
+    }
+
+    /**
+     * NEON has no movemask instruction, compare result is masked with bit weights and added
+     * pairwise until 16 bit mask remains.
+     * @param compareResult Result of vceqq_u8 or other compare, every byte is 0x00 or 0xFF.
+     * @return Mask with bit i set when byte i of compareResult is set.
+     * @since 1.0.0
+     */
+    uint32_t movemask(uint8x16_t compareResult) {
+        static const uint8_t weights[16] = {
+                1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+        };
+        uint8x16_t masked = vandq_u8(compareResult, vld1q_u8(weights));
+        uint8x16_t sum = vpaddq_u8(masked, masked);
+        sum = vpaddq_u8(sum, sum);
+        sum = vpaddq_u8(sum, sum);
+        return vgetq_lane_u16(vreinterpretq_u16_u8(sum), 0);
+    }
+
+#endif
+
+}
+
+#endif //ANDROID_HTML_ITERATOR_SIMDUTILS_H
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "WorkStealingPool.h"
+
+#ifndef ANDROID_HTML_ITERATOR_SPECULATIVETOKENS_H
+#define ANDROID_HTML_ITERATOR_SPECULATIVETOKENS_H
+
+
+/**
+ * Tokens of big content lexed in parallel before the iteration. Content is split into segments
+ * and every segment is lexed on its own thread, speculatively assuming that the segment starts
+ * outside of any tag, comment or script, so segment can start inside of them and its first tokens
+ * can be wrong.
+ * <br>
+ * Every token is determined only by content from its start index (e.g. end of the tag starting at
+ * the index), never by state of the iteration. Iterator so uses token only when its start index
+ * is exactly the index iterator is at, wrong tokens are never reached and iterator lexes the
+ * content by itself until it meets start of the next token again. This is the fix-up for segment
+ * boundaries inside tag, comment, script or &lt;pre&gt;. Iteration itself, so matching of the
+ * tags and delivering results to the callback, stays sequential and in order of the content.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class SpeculativeTokens {
+
+public:
+    using String = std::basic_string<CharT>;
+    using StringView = std::basic_string_view<CharT>;
+
+
+    enum class TokenType : uint8_t {
+
+        /**
+         * Text between tags, <code>end</code> is index of the next '<' char or length of the
+         * content.
+         */
+        TEXT,
+
+        /**
+         * Tag, <code>end</code> is index of '>' char closing the tag.
+         */
+        TAG,
+
+        /**
+         * Comment or cdata, <code>end</code> is index of the last char of the sequence.
+         */
+        SKIPPED,
+    };
+
+
+    /**
+     * @since 1.0.0
+     */
+    struct Token {
+        size_t start;
+        size_t end;
+
+        /**
+         * Offset of collapsed text of TEXT token within <code>Segment::text</code>.
+         */
+        uint32_t textOffset;
+        uint32_t textLength;
+        TokenType type;
+    };
+
+
+    /**
+     * Tokens of single segment, ordered by their start index.
+     * @since 1.0.0
+     */
+    struct Segment {
+        std::vector<Token> tokens;
+
+        /**
+         * Collapsed texts of all TEXT tokens of the segment.
+         */
+        String text;
+    };
+
+
+private:
+    std::vector<Segment> segments;
+    size_t segmentCursor = 0;
+    size_t tokenCursor = 0;
+
+
+public:
+
+    /**
+     * Lexes content in segments on <code>pool</code>, previous tokens are discarded.
+     * @param contentLength Length of the content.
+     * @param pool Pool for lexing, content is split into one segment per worker.
+     * @param lexSegment Function lexing <code>(start, end, Segment &)</code>, lexing starts at
+     * start and continues until start of the next token is at end or after it.
+     * @since 1.0.0
+     */
+    template<typename Lexer>
+    void build(
+            size_t contentLength,
+            WorkStealingPool &pool,
+            Lexer lexSegment
+    ) {
+        clear();
+        size_t segmentsCount = pool.getWorkersCount();
+        segments.resize(segmentsCount);
+        pool.run(segmentsCount, [&](size_t workerIndex) {
+            size_t segmentIndex;
+            while (pool.takeTask(workerIndex, segmentIndex)) {
+                size_t start = segmentIndex * contentLength / segmentsCount;
+                size_t end = (segmentIndex + 1) * contentLength / segmentsCount;
+                lexSegment(start, end, segments[segmentIndex]);
+            }
+        });
+    }
+
+
+    /**
+     * Discards all tokens.
+     * @since 1.0.0
+     */
+    void clear() {
+        segments.clear();
+        segmentCursor = 0;
+        tokenCursor = 0;
+    }
+
+
+    /**
+     * @return True when there are no tokens.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isEmpty() const {
+        return segments.empty();
+    }
+
+
+    /**
+     * Finds token starting exactly at index. Iterator moves forward through the content, so search
+     * continues from the last found position and falls back to binary search when index is before it.
+     * @param index Index within the content.
+     * @return Token starting at index, nullptr when there is no such token.
+     * @since 1.0.0
+     */
+    [[nodiscard]] const Token *find(size_t index) {
+        if (segments.empty()) {
+            return nullptr;
+        }
+        if (!isCursorBefore(index)) {
+            seek(index);
+        }
+
+        while (segmentCursor < segments.size()) {
+            const std::vector<Token> &tokens = segments[segmentCursor].tokens;
+            while (tokenCursor < tokens.size() && tokens[tokenCursor].start < index) {
+                tokenCursor += 1;
+            }
+            if (tokenCursor < tokens.size()) {
+                const Token &token = tokens[tokenCursor];
+                return token.start == index ? &token : nullptr;
+            }
+            segmentCursor += 1;
+            tokenCursor = 0;
+        }
+        return nullptr;
+    }
+
+
+    /**
+     * @param token TEXT token returned by <code>find</code>.
+     * @return Collapsed text of the token, see <code>BasicHtmlIterator::appendCollapsedText</code>.
+     * @since 1.0.0
+     */
+    [[nodiscard]] StringView getText(const Token &token) const {
+        return StringView(segments[segmentCursor].text).substr(token.textOffset, token.textLength);
+    }
+
+
+private:
+
+    /**
+     * @return True when token at cursor doesn't start after index, so forward search from cursor
+     * can find it.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isCursorBefore(size_t index) const {
+        if (segmentCursor >= segments.size()) {
+            return false;
+        }
+        const std::vector<Token> &tokens = segments[segmentCursor].tokens;
+        return tokenCursor >= tokens.size() || tokens[tokenCursor].start <= index;
+    }
+
+
+    /**
+     * Moves cursor to the first token starting at index or after it.
+     * @since 1.0.0
+     */
+    void seek(size_t index) {
+        for (segmentCursor = 0; segmentCursor < segments.size(); segmentCursor++) {
+            const std::vector<Token> &tokens = segments[segmentCursor].tokens;
+            if (!tokens.empty() && tokens.back().start >= index) {
+                tokenCursor = std::lower_bound(
+                        tokens.begin(),
+                        tokens.end(),
+                        index,
+                        [](const Token &token, size_t i) { return token.start < i; }
+                ) - tokens.begin();
+                return;
+            }
+        }
+        tokenCursor = 0;
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_SPECULATIVETOKENS_H
@@ -2,8 +2,11 @@
 /// Created by Miroslav Hýbler on 22.11.2024
 ///
 
+#include <array>
 #include <string>
 #include <ranges>
+#include <type_traits>
+#include "SimdUtils.h"
 
 
 #ifndef ANDROID_HTML_ITERATOR_STRINGUTILS_H
@@ -21,31 +24,48 @@ namespace stringUtils {
 
 
     /**
-     *
+     * Compares two characters ignoring ASCII case. Plain function instead of mutable global
+     * <code>std::function</code> and without <code>std::tolower</code>, which depends on global
+     * locale, so it's safe to call from any thread.
+     * @return True when characters are equal ignoring case.
      * @since 1.0.0
      */
-    std::function<bool(unsigned char)> trimPred = [](unsigned char ch) -> bool {
-        return !std::isspace(ch);
-    };
+    constexpr bool caseInsensitiveCompare(char c1, char c2) {
+        auto ch1 = static_cast<unsigned char>(c1);
+        auto ch2 = static_cast<unsigned char>(c2);
+        if (ch1 >= 'A' && ch1 <= 'Z') ch1 += 'a' - 'A';
+        if (ch2 >= 'A' && ch2 <= 'Z') ch2 += 'a' - 'A';
+        return ch1 == ch2;
+    }
 
 
-    std::function<bool(unsigned char, unsigned char)> caseInsensitiveCompare =
-            [](char c1, char c2) {
-                int ch1 = std::tolower(static_cast<unsigned char>(c1));
-                int ch2 = std::tolower(static_cast<unsigned char>(c2));
-                return ch1 == ch2;
-            };
+    /**
+     * White chars of html indexed by code unit, space, tab, line feed, form feed and carriage
+     * return. Vertical tab is not white char in html, unlike in <code>std::isspace</code>.
+     * @since 1.0.0
+     */
+    inline constexpr std::array<bool, 256> whiteChars = [] {
+        std::array<bool, 256> table{};
+        table[' '] = true;
+        table['\t'] = true;
+        table['\n'] = true;
+        table['\f'] = true;
+        table['\r'] = true;
+        return table;
+    }();
 
 
     /**
     *
     * @param ch Character to be checked
-    * @return True if character is white character, false otherwise.
+    * @return True if character is white character of html, see <code>whiteChars</code>, false
+    * otherwise.
     * @since 1.0.0
     */
-    bool isWhiteChar(char &ch) {
-        //TODO check std::isSpace()
-        return ch == ' ' || ch == '\n' || ch == '\t';
+    template<typename CharT>
+    bool isWhiteChar(const CharT &ch) {
+        auto unit = static_cast<std::make_unsigned_t<CharT>>(ch);
+        return unit < whiteChars.size() && whiteChars[unit];
     }
 
 
@@ -55,7 +75,8 @@ namespace stringUtils {
      * @return True when character is not white character, false otherwise.
      * @since 1.0.0
      */
-    bool isNotWhiteChar(char &ch) {
+    template<typename CharT>
+    bool isNotWhiteChar(const CharT &ch) {
         return !isWhiteChar(ch);
     }
 
@@ -92,6 +113,30 @@ namespace stringUtils {
     }
 
 
+    /**
+     * Checks if s1 of any code unit type is same as ASCII string s2.
+     * @param s1 String you want to compare with s2
+     * @param s2 ASCII string you want to compare with s1
+     * @return True if strings are considered being same. False otherwise.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    bool equals(
+            const std::basic_string_view<CharT> &s1,
+            const std::string_view &s2
+    ) {
+        if (s1.size() != s2.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < s1.size(); i++) {
+            if (s1[i] != static_cast<CharT>(s2[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
     bool equalsCaseInsensitive(
             const std::string_view &s1,
             const std::string_view &s2
@@ -147,9 +192,10 @@ namespace stringUtils {
      * @return
      * @see https://cplusplus.com/reference/string/string/find/
      */
+    template<typename CharT>
     size_t indexOf(
-            const std::string_view &input,
-            const char ch,
+            const std::basic_string_view<CharT> &input,
+            const CharT ch,
             const size_t &i
     ) {
         return input.find(ch, i);
@@ -182,71 +228,14 @@ namespace stringUtils {
     }
 
 
-    /**
-     * Tries to find index of substring within input
-     * @param input Input for searching substring
-     * @param sub Substring you want to search
-     * @param i Start index
-     * @throws std::runtime_error when sub was not found within input from currentIndex
-     * @return index of first found substring
-     * @since 1.0.0
-     */
-    size_t indexOfOrThrow(
-            const std::string_view &input,
-            const std::string &sub,
-            const size_t &i
-    ) {
-        size_t index = indexOf(input, sub, i);
-        if (index == std::string::npos) {
-            throw std::runtime_error(
-                    "Substring \"" + sub +
-                    "\"  was not found within input from index "
-                    + std::to_string(i) + " from the input:\n"
-                    + "=========================================\n"
-                    + std::string(input)
-                    + "\n=========================================\n"
-            );
-        }
-
-        return index;
-    }
-
-
-    /**
-     * Tries to find index of character ch within input from index i.
-     * @param input Input for searching character
-     * @param ch character you want to search
-     * @param i Start index
-     * @return
-     */
-    size_t indexOfOrThrow(
-            const std::string_view &input,
-            const char ch,
-            const size_t &i
-    ) {
-        size_t index = indexOf(input, ch, i);
-        if (index == std::string::npos) {
-            throw std::runtime_error(
-                    "Character \"" + std::string(1, ch) +
-                    "\"  was not found within input from index "
-                    + std::to_string(i) + " from the input:\n"
-                    + "========================================="
-                    + std::string(input)
-                    + "========================================="
-            );
-        }
-
-        return index;
-    }
-
-
     /**
      * Trims input string @s from left (start) side
      * @param s Input string to be trimmed
      * @since 1.0.0
      */
-    inline void ltrim(std::string &s) {
-        s.erase(s.begin(), std::find_if(s.begin(), s.end(), trimPred));
+    template<typename CharT>
+    inline void ltrim(std::basic_string<CharT> &s) {
+        s.erase(s.begin(), std::find_if_not(s.begin(), s.end(), isWhiteChar<CharT>));
     }
 
 
@@ -255,8 +244,9 @@ namespace stringUtils {
      * @param s Input string to be trimmed
      * @since 1.0.0
      */
-    inline void rtrim(std::string &s) {
-        s.erase(std::find_if(s.rbegin(), s.rend(), trimPred).base(), s.end());
+    template<typename CharT>
+    inline void rtrim(std::basic_string<CharT> &s) {
+        s.erase(std::find_if_not(s.rbegin(), s.rend(), isWhiteChar<CharT>).base(), s.end());
     }
 
 
@@ -265,11 +255,30 @@ namespace stringUtils {
      * @param s Input string to be trimmed
      * @since 1.0.0
      */
-    void trim(std::string &s) {
+    template<typename CharT>
+    void trim(std::basic_string<CharT> &s) {
         ltrim(s);
         rtrim(s);
     }
 
+
+    /**
+     * Trims view @s from both sides (start and end). Only the view is narrowed, viewed data are
+     * not copied nor modified.
+     * @param s View to be trimmed
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    void trim(std::basic_string_view<CharT> &s) {
+        auto start = std::find_if_not(s.begin(), s.end(), isWhiteChar<CharT>);
+        auto end = std::find_if_not(s.rbegin(), s.rend(), isWhiteChar<CharT>).base();
+        if (start >= end) {
+            s = std::basic_string_view<CharT>();
+            return;
+        }
+        s = s.substr(start - s.begin(), end - start);
+    }
+
     /**
      * TODO docs
      * @param str
@@ -281,34 +290,38 @@ namespace stringUtils {
         });
     }
 
+    template<typename CharT>
     bool startsWith(
-            const std::string &text,
+            const std::basic_string<CharT> &text,
             const char &ch
     ) {
-        return !text.empty() && text.front() == ch;
+        return !text.empty() && text.front() == static_cast<CharT>(ch);
     }
 
+    template<typename CharT>
     bool startsWith(
-            const std::string_view &text,
+            const std::basic_string_view<CharT> &text,
             const char &ch
     ) {
-        return !text.empty() && text.front() == ch;
+        return !text.empty() && text.front() == static_cast<CharT>(ch);
     }
 
 
+    template<typename CharT>
     bool endsWith(
-            const std::string &text,
+            const std::basic_string<CharT> &text,
             const char &ch
     ) {
-        return !text.empty() && text.back() == ch;
+        return !text.empty() && text.back() == static_cast<CharT>(ch);
     }
 
 
+    template<typename CharT>
     bool endsWith(
-            const std::string_view &text,
+            const std::basic_string_view<CharT> &text,
             const char &ch
     ) {
-        return !text.empty() && text.back() == ch;
+        return !text.empty() && text.back() == static_cast<CharT>(ch);
     }
 
 
@@ -423,6 +436,53 @@ namespace stringUtils {
     }
 
 
+    /**
+     * Vectorized kernel for white chars detection, checks 16 code units at once.
+     * @param input Pointer to 16 code units to be checked.
+     * @return Mask with bit i set when input[i] is white character, 0 when platform has no
+     * supported instruction set.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    uint32_t whiteCharsMask16(const CharT *input) {
+#if HTML_ITERATOR_SIMD_SSE2
+        __m128i chunk = simdUtils::load16(input);
+        __m128i white = _mm_or_si128(
+                _mm_or_si128(
+                        _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))
+                ),
+                _mm_or_si128(
+                        _mm_or_si128(
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')),
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))
+                        ),
+                        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\f'))
+                )
+        );
+        return static_cast<uint32_t>(_mm_movemask_epi8(white));
+#elif HTML_ITERATOR_SIMD_NEON
+        uint8x16_t chunk = simdUtils::load16(input);
+        uint8x16_t white = vorrq_u8(
+                vorrq_u8(
+                        vceqq_u8(chunk, vdupq_n_u8(' ')),
+                        vceqq_u8(chunk, vdupq_n_u8('\n'))
+                ),
+                vorrq_u8(
+                        vorrq_u8(
+                                vceqq_u8(chunk, vdupq_n_u8('\t')),
+                                vceqq_u8(chunk, vdupq_n_u8('\r'))
+                        ),
+                        vceqq_u8(chunk, vdupq_n_u8('\f'))
+                )
+        );
+        return simdUtils::movemask(white);
+#else
+        return 0;
+#endif
+    }
+
+
     /**
      *
      * @param input Input where to search for next white charected.
@@ -431,12 +491,21 @@ namespace stringUtils {
      * @return Index of first white character from start index to end index or std::string::npos if not found.
      * @since 1.0.0
      */
+    template<typename CharT>
     size_t nextWhiteChar(
-            std::string_view input,
+            std::basic_string_view<CharT> input,
             size_t start,
             size_t end
     ) {
-        char ch;
+#if HTML_ITERATOR_SIMD_SSE2 || HTML_ITERATOR_SIMD_NEON
+        for (; start + 16 <= end; start += 16) {
+            uint32_t mask = whiteCharsMask16(input.data() + start);
+            if (mask != 0) {
+                return start + __builtin_ctz(mask);
+            }
+        }
+#endif
+        CharT ch;
         for (size_t i = start; i < end; i++) {
             ch = input[i];
             if (stringUtils::isWhiteChar(ch)) {
@@ -456,12 +525,21 @@ namespace stringUtils {
      * @return Index of first non white character from start index to end index or std::string::npos if not found.
      * @since 1.0.0
      */
+    template<typename CharT>
     size_t nextNonWhiteChar(
-            std::string_view input,
+            std::basic_string_view<CharT> input,
             size_t start,
             size_t end
     ) {
-        char ch;
+#if HTML_ITERATOR_SIMD_SSE2 || HTML_ITERATOR_SIMD_NEON
+        for (; start + 16 <= end; start += 16) {
+            uint32_t mask = ~whiteCharsMask16(input.data() + start) & 0xFFFF;
+            if (mask != 0) {
+                return start + __builtin_ctz(mask);
+            }
+        }
+#endif
+        CharT ch;
         for (size_t i = start; i < end; i++) {
             ch = input[i];
             if (stringUtils::isNotWhiteChar(ch)) {
@@ -0,0 +1,519 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "SimdUtils.h"
+
+#ifndef ANDROID_HTML_ITERATOR_STRUCTURALINDEX_H
+#define ANDROID_HTML_ITERATOR_STRUCTURALINDEX_H
+
+
+/**
+ * Structural index of html content, first pass over the content before the tokenization. Holds
+ * bitmaps with one bit per byte of content for every structural character, so the iterator can
+ * jump from one structural character to another instead of reading content byte by byte.
+ * <br>
+ * Bitmaps are built by vectorized kernels processing 64 bytes at a time (AVX2 or SSE2 on x86,
+ * NEON on arm64) with scalar fallback for other platforms. UTF-16 content is narrowed into bytes
+ * with saturation first, so the same kernels are used and one bit still maps to one code unit.
+ * @since 1.0.0
+ */
+class StructuralIndex {
+
+private:
+
+    /**
+     * Masks of single 64 bytes block, bit i is set when byte i of the block is the character.
+     * @since 1.0.0
+     */
+    struct BlockMasks {
+        uint64_t lt = 0;
+        uint64_t gt = 0;
+        uint64_t quote = 0;
+        uint64_t apostrophe = 0;
+        uint64_t bang = 0;
+        uint64_t dash = 0;
+    };
+
+
+    /**
+     * Bits of '<' characters.
+     * @since 1.0.0
+     */
+    std::vector<uint64_t> tagStarts;
+
+
+    /**
+     * Bits of '>' characters.
+     * @since 1.0.0
+     */
+    std::vector<uint64_t> tagEnds;
+
+
+    /**
+     * Bits of '"' and '\'' characters.
+     * @since 1.0.0
+     */
+    std::vector<uint64_t> quotes;
+
+
+    /**
+     * Bits of '<' characters starting comment sequence "<!--".
+     * @since 1.0.0
+     */
+    std::vector<uint64_t> commentStarts;
+
+
+    /**
+     * Length of indexed content.
+     * @since 1.0.0
+     */
+    size_t length = 0;
+
+
+public:
+
+    /**
+     * Builds index for the content, previous index is discarded.
+     * @param data Content to be indexed, UTF-8 or UTF-16 code units.
+     * @param dataLength Length of the data in code units.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    void build(
+            const CharT *data,
+            size_t dataLength
+    ) {
+        clear();
+        append(data, dataLength);
+    }
+
+
+    /**
+     * Extends index for content which grew at its end, e.g. by streamed chunk. Only the appended
+     * part is indexed, with the last indexed block, so sequences overlapping into appended part are
+     * found too.
+     * @param data Whole content, indexed part has to be unchanged since previous call.
+     * @param dataLength Length of the whole data in code units.
+     * @since 1.0.0
+     */
+    template<typename CharT>
+    void append(
+            const CharT *data,
+            size_t dataLength
+    ) {
+        size_t blocksCount = (dataLength + 63) / 64;
+        //Block with the first appended code unit is indexed again, comment starts of the block
+        //before it may overlap into appended part
+        size_t firstBlock = length / 64;
+        if (firstBlock > 0) {
+            firstBlock -= 1;
+        }
+        this->length = dataLength;
+        tagStarts.resize(blocksCount, 0);
+        tagEnds.resize(blocksCount, 0);
+        quotes.resize(blocksCount, 0);
+        commentStarts.resize(blocksCount, 0);
+
+        if (firstBlock >= blocksCount) {
+            return;
+        }
+
+        BlockMasks previous;
+        BlockMasks current;
+        for (size_t block = firstBlock; block < blocksCount; block++) {
+            size_t offset = block * 64;
+            if (offset + 64 <= dataLength) {
+                findStructuralChars(data + offset, current);
+            } else {
+                //Last block is padded with zeros, zero is not structural char
+                CharT padded[64] = {};
+                std::memcpy(padded, data + offset, (dataLength - offset) * sizeof(CharT));
+                findStructuralChars(padded, current);
+            }
+
+            tagStarts[block] = current.lt;
+            tagEnds[block] = current.gt;
+            quotes[block] = current.quote | current.apostrophe;
+
+            if (block > firstBlock) {
+                commentStarts[block - 1] = findCommentStarts(previous, current);
+            }
+            previous = current;
+        }
+        commentStarts[blocksCount - 1] = findCommentStarts(previous, BlockMasks());
+    }
+
+
+    /**
+     * Drops index of first count code units, which were removed from the start of the content, so
+     * the rest doesn't have to be indexed again.
+     * @param count Count of removed code units.
+     * @since 1.0.0
+     */
+    void erasePrefix(size_t count) {
+        if (count >= length) {
+            clear();
+            return;
+        }
+        this->length -= count;
+        size_t blocksCount = (length + 63) / 64;
+        shiftBitmap(tagStarts, count, blocksCount);
+        shiftBitmap(tagEnds, count, blocksCount);
+        shiftBitmap(quotes, count, blocksCount);
+        shiftBitmap(commentStarts, count, blocksCount);
+    }
+
+
+    /**
+     * Clears the index.
+     * @since 1.0.0
+     */
+    void clear() {
+        this->length = 0;
+        tagStarts.clear();
+        tagEnds.clear();
+        quotes.clear();
+        commentStarts.clear();
+    }
+
+
+    /**
+     * @param i Start index, inclusive.
+     * @return Index of next '<' char from i, std::string::npos if there is no other.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t nextTagStart(size_t i) const {
+        return nextSetBit(tagStarts, i);
+    }
+
+
+    /**
+     * @param i Start index, inclusive.
+     * @return Index of next '>' char from i, std::string::npos if there is no other.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t nextTagEnd(size_t i) const {
+        return nextSetBit(tagEnds, i);
+    }
+
+
+    /**
+     * @param i Start index, inclusive.
+     * @return Index of next '"' or '\'' char from i, std::string::npos if there is no other.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t nextQuote(size_t i) const {
+        return nextSetBit(quotes, i);
+    }
+
+
+    /**
+     * @param i Index of '<' char.
+     * @return True when "<!--" sequence starts at i.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool isCommentStart(size_t i) const {
+        if (i >= length) {
+            return false;
+        }
+        return (commentStarts[i / 64] >> (i % 64)) & 1;
+    }
+
+
+private:
+
+
+    /**
+     * Finds index of next set bit in bitmap from index i.
+     * @param bitmap Bitmap to search in.
+     * @param i Start index, inclusive.
+     * @return Index of next set bit, std::string::npos when there is no other.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t nextSetBit(
+            const std::vector<uint64_t> &bitmap,
+            size_t i
+    ) const {
+        if (i >= length) {
+            return std::string::npos;
+        }
+
+        size_t block = i / 64;
+        //Clearing bits before i in the first block
+        uint64_t bits = bitmap[block] & (~uint64_t(0) << (i % 64));
+        while (bits == 0) {
+            block += 1;
+            if (block >= bitmap.size()) {
+                return std::string::npos;
+            }
+            bits = bitmap[block];
+        }
+        return block * 64 + __builtin_ctzll(bits);
+    }
+
+
+    /**
+     * Moves bits of the bitmap count positions down, bits shifted in above the old end are zeros.
+     * @param bitmap Bitmap to shift.
+     * @param count Count of dropped bits.
+     * @param blocksCount Count of blocks kept.
+     * @since 1.0.0
+     */
+    static void shiftBitmap(
+            std::vector<uint64_t> &bitmap,
+            size_t count,
+            size_t blocksCount
+    ) {
+        size_t blockShift = count / 64;
+        size_t bitShift = count % 64;
+        size_t size = bitmap.size();
+        for (size_t block = 0; block < blocksCount; block++) {
+            uint64_t bits = bitmap[block + blockShift];
+            if (bitShift != 0) {
+                bits >>= bitShift;
+                if (block + blockShift + 1 < size) {
+                    bits |= bitmap[block + blockShift + 1] << (64 - bitShift);
+                }
+            }
+            bitmap[block] = bits;
+        }
+        bitmap.resize(blocksCount);
+    }
+
+
+    /**
+     * Comment starts are '<' followed by '!', '-', '-'. Sequence can overlap into the next block,
+     * so low bits of the next block are shifted in.
+     * @param block Masks of the block.
+     * @param next Masks of the next block, empty for the last block.
+     * @return Bits of comment starts in the block.
+     * @since 1.0.0
+     */
+    static uint64_t findCommentStarts(
+            const BlockMasks &block,
+            const BlockMasks &next
+    ) {
+        uint64_t bang1 = (block.bang >> 1) | (next.bang << 63);
+        uint64_t dash2 = (block.dash >> 2) | (next.dash << 62);
+        uint64_t dash3 = (block.dash >> 3) | (next.dash << 61);
+        return block.lt & bang1 & dash2 & dash3;
+    }
+
+
+    /**
+     * Narrows 64 UTF-16 code units block into bytes and fills its masks.
+     * @param block Pointer to 64 code units of data.
+     * @param outMasks Masks of the block.
+     * @since 1.0.0
+     */
+    static void findStructuralChars(
+            const char16_t *block,
+            BlockMasks &outMasks
+    ) {
+        alignas(16) char narrowed[64];
+#if HTML_ITERATOR_SIMD_SSE2
+        for (int i = 0; i < 64; i += 16) {
+            _mm_store_si128(reinterpret_cast<__m128i *>(narrowed + i), simdUtils::load16(block + i));
+        }
+#elif HTML_ITERATOR_SIMD_NEON
+        for (int i = 0; i < 64; i += 16) {
+            vst1q_u8(reinterpret_cast<uint8_t *>(narrowed + i), simdUtils::load16(block + i));
+        }
+#else
+        for (int i = 0; i < 64; i++) {
+            narrowed[i] = block[i] < 0x80 ? static_cast<char>(block[i]) : '\0';
+        }
+#endif
+        findStructuralChars(narrowed, outMasks);
+    }
+
+
+    /**
+     * Fills masks for 64 bytes block using the best kernel available on the platform.
+     * @param block Pointer to 64 bytes of data.
+     * @param outMasks Masks of the block.
+     * @since 1.0.0
+     */
+    static void findStructuralChars(
+            const char *block,
+            BlockMasks &outMasks
+    ) {
+#if HTML_ITERATOR_SIMD_X86
+        static const bool isAvx2Supported = __builtin_cpu_supports("avx2");
+        if (isAvx2Supported) {
+            findStructuralCharsAvx2(block, outMasks);
+        } else {
+            findStructuralCharsSse2(block, outMasks);
+        }
+#elif HTML_ITERATOR_SIMD_NEON
+        findStructuralCharsNeon(block, outMasks);
+#else
+        findStructuralCharsScalar(block, outMasks);
+#endif
+    }
+
+
+#if HTML_ITERATOR_SIMD_X86
+
+    __attribute__((target("avx2")))
+    static void findStructuralCharsAvx2(
+            const char *block,
+            BlockMasks &outMasks
+    ) {
+        const __m256i lt = _mm256_set1_epi8('<');
+        const __m256i gt = _mm256_set1_epi8('>');
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i apostrophe = _mm256_set1_epi8('\'');
+        const __m256i bang = _mm256_set1_epi8('!');
+        const __m256i dash = _mm256_set1_epi8('-');
+
+        outMasks = BlockMasks();
+        for (int i = 0; i < 2; i++) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i * 32));
+            int shift = i * 32;
+            outMasks.lt |= toMask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, lt)), shift);
+            outMasks.gt |= toMask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, gt)), shift);
+            outMasks.quote |= toMask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)), shift);
+            outMasks.apostrophe |= toMask(
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, apostrophe)),
+                    shift
+            );
+            outMasks.bang |= toMask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, bang)), shift);
+            outMasks.dash |= toMask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, dash)), shift);
+        }
+    }
+
+
+    static void findStructuralCharsSse2(
+            const char *block,
+            BlockMasks &outMasks
+    ) {
+        const __m128i lt = _mm_set1_epi8('<');
+        const __m128i gt = _mm_set1_epi8('>');
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i apostrophe = _mm_set1_epi8('\'');
+        const __m128i bang = _mm_set1_epi8('!');
+        const __m128i dash = _mm_set1_epi8('-');
+
+        outMasks = BlockMasks();
+        for (int i = 0; i < 4; i++) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16));
+            int shift = i * 16;
+            outMasks.lt |= toMask(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, lt)), shift);
+            outMasks.gt |= toMask(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, gt)), shift);
+            outMasks.quote |= toMask(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)), shift);
+            outMasks.apostrophe |= toMask(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, apostrophe)),
+                    shift
+            );
+            outMasks.bang |= toMask(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, bang)), shift);
+            outMasks.dash |= toMask(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, dash)), shift);
+        }
+    }
+
+
+    /**
+     * @param movemask Result of movemask instruction.
+     * @param shift Offset of the chunk within the block.
+     * @return Movemask placed on its position in 64 bit block mask.
+     * @since 1.0.0
+     */
+    static uint64_t toMask(
+            int movemask,
+            int shift
+    ) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(movemask)) << shift;
+    }
+
+#endif
+
+#if HTML_ITERATOR_SIMD_NEON
+
+    static void findStructuralCharsNeon(
+            const char *block,
+            BlockMasks &outMasks
+    ) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(block);
+        uint8x16_t chunk0 = vld1q_u8(bytes);
+        uint8x16_t chunk1 = vld1q_u8(bytes + 16);
+        uint8x16_t chunk2 = vld1q_u8(bytes + 32);
+        uint8x16_t chunk3 = vld1q_u8(bytes + 48);
+
+        outMasks.lt = movemask(chunk0, chunk1, chunk2, chunk3, '<');
+        outMasks.gt = movemask(chunk0, chunk1, chunk2, chunk3, '>');
+        outMasks.quote = movemask(chunk0, chunk1, chunk2, chunk3, '"');
+        outMasks.apostrophe = movemask(chunk0, chunk1, chunk2, chunk3, '\'');
+        outMasks.bang = movemask(chunk0, chunk1, chunk2, chunk3, '!');
+        outMasks.dash = movemask(chunk0, chunk1, chunk2, chunk3, '-');
+    }
+
+
+    /**
+     * NEON has no movemask instruction, compare results are masked with bit weights and added
+     * pairwise until single 64 bit mask remains.
+     * @return Mask with bit i set when byte i of the block is ch.
+     * @since 1.0.0
+     */
+    static uint64_t movemask(
+            uint8x16_t chunk0,
+            uint8x16_t chunk1,
+            uint8x16_t chunk2,
+            uint8x16_t chunk3,
+            uint8_t ch
+    ) {
+        static const uint8_t weights[16] = {
+                1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+        };
+        const uint8x16_t bitWeights = vld1q_u8(weights);
+        const uint8x16_t needle = vdupq_n_u8(ch);
+
+        uint8x16_t m0 = vandq_u8(vceqq_u8(chunk0, needle), bitWeights);
+        uint8x16_t m1 = vandq_u8(vceqq_u8(chunk1, needle), bitWeights);
+        uint8x16_t m2 = vandq_u8(vceqq_u8(chunk2, needle), bitWeights);
+        uint8x16_t m3 = vandq_u8(vceqq_u8(chunk3, needle), bitWeights);
+
+        uint8x16_t sum0 = vpaddq_u8(m0, m1);
+        uint8x16_t sum1 = vpaddq_u8(m2, m3);
+        sum0 = vpaddq_u8(sum0, sum1);
+        sum0 = vpaddq_u8(sum0, sum0);
+        return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+    }
+
+#endif
+
+
+    static void findStructuralCharsScalar(
+            const char *block,
+            BlockMasks &outMasks
+    ) {
+        outMasks = BlockMasks();
+        for (int i = 0; i < 64; i++) {
+            uint64_t bit = uint64_t(1) << i;
+            switch (block[i]) {
+                case '<':
+                    outMasks.lt |= bit;
+                    break;
+                case '>':
+                    outMasks.gt |= bit;
+                    break;
+                case '"':
+                    outMasks.quote |= bit;
+                    break;
+                case '\'':
+                    outMasks.apostrophe |= bit;
+                    break;
+                case '!':
+                    outMasks.bang |= bit;
+                    break;
+                case '-':
+                    outMasks.dash |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_STRUCTURALINDEX_H
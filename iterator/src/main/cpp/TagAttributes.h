@@ -0,0 +1,372 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "HtmlEntities.h"
+#include "HtmlNames.h"
+#include "HtmlUtils.h"
+
+#ifndef ANDROID_HTML_ITERATOR_TAGATTRIBUTES_H
+#define ANDROID_HTML_ITERATOR_TAGATTRIBUTES_H
+
+
+/**
+ * Attributes of single tag stored flat as offsets of names and values within the body of the tag.
+ * First <code>INLINE_CAPACITY</code> attributes are stored inline, so parsing and reading
+ * attributes of typical tag allocates nothing, rest of the attributes is stored in vector. Offsets
+ * are relative to the body, so tag moving its body keeps its attributes by <code>rebase</code>.
+ * <br>
+ * Attributes read most often (id, class, href, src, style, alt) have fixed slots, so they are read
+ * without any lookup. Names are matched case insensitively, first occurrence of attribute wins, same
+ * as in browsers. Iteration keeps order of the attributes in the body.
+ * <br>
+ * Character references in values are decoded. Only values having '&amp;' are decoded, their decoded
+ * copies are kept in <code>decodedValues</code>, rest of the values stay views into the body.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class BasicTagAttributes {
+
+public:
+    using String = std::basic_string<CharT>;
+    using StringView = std::basic_string_view<CharT>;
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+
+    /**
+     * Count of attributes stored inline, tags have rarely more attributes.
+     * @since 1.0.0
+     */
+    static constexpr size_t INLINE_CAPACITY = 6;
+
+
+private:
+
+    struct Entry {
+        uint32_t nameStart;
+        uint32_t nameLength;
+        uint32_t valueStart;
+        uint32_t valueLength;
+        htmlNames::AttributeId id;
+
+        /**
+         * True when value is in <code>decodedValues</code> instead of the body.
+         */
+        bool isDecoded;
+    };
+
+
+    /**
+     * Attributes having fixed slot, see <code>getSlot</code>.
+     * @since 1.0.0
+     */
+    enum Slot : uint8_t {
+        SLOT_ID = 0,
+        SLOT_CLASS,
+        SLOT_HREF,
+        SLOT_SRC,
+        SLOT_STYLE,
+        SLOT_ALT,
+        SLOTS_COUNT,
+        SLOT_NONE = SLOTS_COUNT,
+    };
+
+
+    const CharT *base = nullptr;
+    std::array<Entry, INLINE_CAPACITY> inlineEntries{};
+    std::pmr::vector<Entry> overflowEntries;
+    uint32_t count = 0;
+
+
+    /**
+     * Values with decoded character references, null until some value needs decoding. Shared by
+     * copies, so views of decoded values stay valid in copies.
+     * @since 1.0.0
+     */
+    std::shared_ptr<String> decodedValues;
+
+
+    /**
+     * Index of attribute + 1 for every slot, 0 when tag has no such attribute.
+     * @since 1.0.0
+     */
+    std::array<uint32_t, SLOTS_COUNT> slots{};
+
+
+public:
+
+    /**
+     * Iterator over attributes as pairs of name and value.
+     * @since 1.0.0
+     */
+    class Iterator {
+
+    private:
+        const BasicTagAttributes *attributes;
+        size_t index;
+
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<StringView, StringView>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+
+        Iterator(const BasicTagAttributes *attributes, size_t index)
+                : attributes(attributes), index(index) {
+        }
+
+
+        value_type operator*() const {
+            return attributes->get(index);
+        }
+
+
+        Iterator &operator++() {
+            index += 1;
+            return *this;
+        }
+
+
+        bool operator==(const Iterator &other) const {
+            return index == other.index;
+        }
+
+
+        bool operator!=(const Iterator &other) const {
+            return index != other.index;
+        }
+    };
+
+
+    explicit BasicTagAttributes(const allocator_type &allocator = {}) : overflowEntries(allocator) {
+    }
+
+
+    BasicTagAttributes(const BasicTagAttributes &other) = default;
+
+
+    BasicTagAttributes(
+            const BasicTagAttributes &other,
+            const allocator_type &allocator
+    ) : base(other.base),
+        inlineEntries(other.inlineEntries),
+        overflowEntries(other.overflowEntries, allocator),
+        count(other.count),
+        decodedValues(other.decodedValues),
+        slots(other.slots) {
+    }
+
+
+    BasicTagAttributes &operator=(const BasicTagAttributes &other) = default;
+
+
+    /**
+     * Parses attributes from body, previous attributes are dropped.
+     * @param body Body of the tag, attributes are views into it.
+     * @since 1.0.0
+     */
+    void parse(const StringView &body) {
+        clear();
+        this->base = body.data();
+        htmlUtils::getTagAttributes(body, *this);
+    }
+
+
+    /**
+     * Adds attribute unless tag has attribute of the same name already. Used by
+     * <code>htmlUtils::getTagAttributes</code>.
+     * @param name View into the body.
+     * @param value View into the body, empty for attribute without value. Value with character
+     * references is decoded into <code>decodedValues</code>.
+     * @since 1.0.0
+     */
+    void emplace(
+            const StringView &name,
+            const StringView &value
+    ) {
+        htmlNames::AttributeId id = htmlNames::getAttributeId(name);
+        if (findIndex(id, name) != SIZE_MAX) {
+            return;
+        }
+        Entry entry{
+                toOffset(name),
+                static_cast<uint32_t>(name.length()),
+                value.empty() ? 0 : toOffset(value),
+                static_cast<uint32_t>(value.length()),
+                id,
+                false
+        };
+        if (value.find('&') != StringView::npos) {
+            if (decodedValues == nullptr) {
+                decodedValues = std::make_shared<String>();
+            }
+            entry.valueStart = static_cast<uint32_t>(decodedValues->length());
+            htmlEntities::appendDecoded(*decodedValues, value, true);
+            entry.valueLength = static_cast<uint32_t>(decodedValues->length() - entry.valueStart);
+            entry.isDecoded = true;
+        }
+        if (count < INLINE_CAPACITY) {
+            inlineEntries[count] = entry;
+        } else {
+            overflowEntries.push_back(entry);
+        }
+        Slot slot = getSlot(id);
+        if (slot != SLOT_NONE) {
+            slots[slot] = count + 1;
+        }
+        count += 1;
+    }
+
+
+    /**
+     * @param id Id of well known attribute.
+     * @return Value of the attribute, empty when tag has no such attribute.
+     * @since 1.0.0
+     */
+    [[nodiscard]] StringView find(htmlNames::AttributeId id) const {
+        size_t index = findIndex(id, {});
+        return index != SIZE_MAX ? get(index).second : StringView();
+    }
+
+
+    /**
+     * @param name Name of the attribute, matched case insensitively.
+     * @return Value of the attribute, empty when tag has no such attribute.
+     * @since 1.0.0
+     */
+    [[nodiscard]] StringView find(const StringView &name) const {
+        size_t index = findIndex(htmlNames::getAttributeId(name), name);
+        return index != SIZE_MAX ? get(index).second : StringView();
+    }
+
+
+    /**
+     * @param name Name of the attribute, matched case insensitively.
+     * @return True when tag has the attribute, also when it has no value.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool contains(const StringView &name) const {
+        return findIndex(htmlNames::getAttributeId(name), name) != SIZE_MAX;
+    }
+
+
+    /**
+     * @return Name and value of attribute at index.
+     * @since 1.0.0
+     */
+    [[nodiscard]] std::pair<StringView, StringView> get(size_t index) const {
+        const Entry &entry = index < INLINE_CAPACITY
+                             ? inlineEntries[index]
+                             : overflowEntries[index - INLINE_CAPACITY];
+        const CharT *valueBase = entry.isDecoded ? decodedValues->data() : base;
+        return {
+                StringView(base + entry.nameStart, entry.nameLength),
+                entry.valueLength > 0 ? StringView(valueBase + entry.valueStart, entry.valueLength) : StringView()
+        };
+    }
+
+
+    /**
+     * Points attributes to the copy of the body, decoded values stay where they are.
+     * @param newBase Data of the body copy.
+     * @since 1.0.0
+     */
+    void rebase(const CharT *newBase) {
+        this->base = newBase;
+    }
+
+
+    void clear() {
+        count = 0;
+        slots.fill(0);
+        overflowEntries.clear();
+        //Copies may still use decoded values
+        decodedValues.reset();
+    }
+
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+
+    [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+
+    [[nodiscard]] Iterator begin() const {
+        return Iterator(this, 0);
+    }
+
+
+    [[nodiscard]] Iterator end() const {
+        return Iterator(this, count);
+    }
+
+
+private:
+
+    [[nodiscard]] uint32_t toOffset(const StringView &view) const {
+        return static_cast<uint32_t>(view.data() - base);
+    }
+
+
+    /**
+     * @param id Id of the attribute, UNKNOWN for not well known attribute.
+     * @param name Name of the attribute, used only when id is UNKNOWN.
+     * @return Index of the attribute, SIZE_MAX when tag has no such attribute.
+     * @since 1.0.0
+     */
+    [[nodiscard]] size_t findIndex(
+            htmlNames::AttributeId id,
+            const StringView &name
+    ) const {
+        Slot slot = getSlot(id);
+        if (slot != SLOT_NONE) {
+            return slots[slot] != 0 ? slots[slot] - 1 : SIZE_MAX;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const Entry &entry = i < INLINE_CAPACITY ? inlineEntries[i] : overflowEntries[i - INLINE_CAPACITY];
+            if (entry.id != id) {
+                continue;
+            }
+            if (id != htmlNames::AttributeId::UNKNOWN
+                || htmlNames::equalsIgnoreCase(get(i).first, name)) {
+                return i;
+            }
+        }
+        return SIZE_MAX;
+    }
+
+
+    [[nodiscard]] static Slot getSlot(htmlNames::AttributeId id) {
+        switch (id) {
+            case htmlNames::AttributeId::ID:
+                return SLOT_ID;
+            case htmlNames::AttributeId::CLASS:
+                return SLOT_CLASS;
+            case htmlNames::AttributeId::HREF:
+                return SLOT_HREF;
+            case htmlNames::AttributeId::SRC:
+                return SLOT_SRC;
+            case htmlNames::AttributeId::STYLE:
+                return SLOT_STYLE;
+            case htmlNames::AttributeId::ALT:
+                return SLOT_ALT;
+            default:
+                return SLOT_NONE;
+        }
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_TAGATTRIBUTES_H
@@ -3,101 +3,183 @@
 ///
 
 #include <string>
-#include <map>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include "HtmlUtils.h"
+#include "TagAttributes.h"
 
 #ifndef ANDROID_HTML_ITERATOR_TAGINFO_H
 #define ANDROID_HTML_ITERATOR_TAGINFO_H
 
 /**
- * Holding info of tag from html content
+ * Holding info of tag from html content. Tag, body, attributes and classes are views into the
+ * content of HtmlIterator, so TagInfo is valid only while the content is set and it's not copying
+ * any part of the content.
+ * <br>
+ * Attributes and classes are parsed lazily on first access, most of the tags are never asked for
+ * them.
+ * <br>
+ * When the content is streamed, consumed part of the content is released, so tags which have to
+ * outlive it take a copy of their body by <code>ownBody</code>.
+ * <br>
+ * Tag is allocator aware, tags in containers of HtmlIterator keep parsed attributes and classes in
+ * memory of the document, see DocumentArena. Copies made outside of such containers use default
+ * memory resource.
+ * <br>
+ * CharT is type of code units of the content, char for UTF-8 and char16_t for UTF-16.
  * @since 1.0.0
  */
-struct TagInfo {
+template<typename CharT>
+struct BasicTagInfo {
+
+public:
+    using String = std::basic_string<CharT>;
+    using StringView = std::basic_string_view<CharT>;
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
 
 private:
-    std::map<std::string, std::string> attributes;
-    std::vector<std::string> clazz;
+    mutable BasicTagAttributes<CharT> attributes;
+    mutable std::pmr::vector<StringView> clazz;
+    mutable bool isAttributesParsed = false;
+    mutable bool isClassesParsed = false;
     bool isSingle;
-    std::string tag;
-    std::string body;
-    size_t pairContentStartIndex = 0;
-    size_t pairContentEndIndex = 0;
+    htmlNames::TagId tagId;
+    uint8_t tagFlags;
+    StringView tag;
+    StringView body;
+
+    /**
+     * Copy of the body when tag owns its data, shared by copies of the tag so views stay valid.
+     */
+    std::shared_ptr<const String> ownedBody;
+    uint64_t pairContentStartIndex = 0;
+    uint64_t pairContentEndIndex = 0;
 
 public:
-    TagInfo(
-            std::string &newTag,
-            std::string &newBody
-    ) {
+    BasicTagInfo(
+            const StringView &newTag,
+            const StringView &newBody,
+            const allocator_type &allocator = {}
+    ) : attributes(allocator), clazz(allocator) {
         this->tag = newTag;
         this->body = newBody;
-        this->isSingle = htmlUtils::isSingleTag(this->body);
-        htmlUtils::extractClasses(this->body, this->clazz);
-        htmlUtils::getTagAttributes(this->body, this->attributes);
-
-        if (this->isSingle) {
-            std::string classesString = attributes["class"];
-            if (!classesString.empty()) {
-                htmlUtils::extractClasses(classesString, this->clazz);
-            }
-        }
-
+        this->tagId = htmlNames::getTagId(this->tag);
+        this->tagFlags = htmlNames::getTagFlags(this->tagId);
+        this->isSingle = stringUtils::endsWith(this->body, '/')
+                         || hasFlag(htmlNames::TAG_FLAG_VOID);
     };
 
-    TagInfo(
-            std::string &newTag,
-            std::string &newBody,
-            std::map<std::string, std::string> &attributes
-    ) {
-        this->tag = newTag;
-        this->body = newBody;
-        this->attributes = attributes;
-        this->isSingle = htmlUtils::isSingleTag(this->body);
-    };
+    BasicTagInfo(const BasicTagInfo &other) = default;
+
 
-    ~TagInfo() = default;
+    /**
+     * Copies the tag into memory of <code>allocator</code>, used by allocator aware containers.
+     * @since 1.0.0
+     */
+    BasicTagInfo(
+            const BasicTagInfo &other,
+            const allocator_type &allocator
+    ) : attributes(other.attributes, allocator),
+        clazz(other.clazz, allocator),
+        isAttributesParsed(other.isAttributesParsed),
+        isClassesParsed(other.isClassesParsed),
+        isSingle(other.isSingle),
+        tagId(other.tagId),
+        tagFlags(other.tagFlags),
+        tag(other.tag),
+        body(other.body),
+        ownedBody(other.ownedBody),
+        pairContentStartIndex(other.pairContentStartIndex),
+        pairContentEndIndex(other.pairContentEndIndex) {
+    }
+
+
+    BasicTagInfo &operator=(const BasicTagInfo &other) = default;
+
+    ~BasicTagInfo() = default;
 
 
     void setPairContent(
-            const size_t start,
-            const size_t end
+            const uint64_t start,
+            const uint64_t end
     ) {
         this->pairContentStartIndex = start;
         this->pairContentEndIndex = end;
     }
 
 
-    [[nodiscard]] std::string getTag() const {
+    [[nodiscard]] StringView getTag() const {
         return this->tag;
     }
 
 
-    [[nodiscard]] std::string getBody() const {
+    [[nodiscard]] StringView getBody() const {
         return this->body;
     }
 
 
-    [[nodiscard]] std::string getAttribute(const std::string &name) {
-        return this->attributes[name];
+    /**
+     * @return Id of the tag, TagId::UNKNOWN when tag is not well known.
+     * @since 1.0.0
+     */
+    [[nodiscard]] htmlNames::TagId getTagId() const {
+        return this->tagId;
+    }
+
+
+    /**
+     * @param flag Flag from <code>htmlNames::TagFlag</code>.
+     * @return True when tag is well known tag having the flag.
+     * @since 1.0.0
+     */
+    [[nodiscard]] bool hasFlag(const htmlNames::TagFlag flag) const {
+        return (this->tagFlags & flag) != 0;
+    }
+
+
+    /**
+     * @param name Name of the attribute, matched case insensitively.
+     * @return Value of the attribute, empty when tag has no such attribute.
+     * @since 1.0.0
+     */
+    [[nodiscard]] StringView getAttribute(const StringView &name) const {
+        parseAttributesIfNeeded();
+        return this->attributes.find(name);
     }
 
 
-    [[nodiscard]] std::map<std::string, std::string> getOutMap() const {
+    /**
+     * @param id Id of well known attribute, id, class, href, src, style and alt are read from fixed
+     * slots without any lookup.
+     * @return Value of the attribute, empty when tag has no such attribute.
+     * @since 1.0.0
+     */
+    [[nodiscard]] StringView getAttribute(const htmlNames::AttributeId id) const {
+        parseAttributesIfNeeded();
+        return this->attributes.find(id);
+    }
+
+
+    [[nodiscard]] const BasicTagAttributes<CharT> &getOutMap() const {
+        parseAttributesIfNeeded();
         return this->attributes;
     }
 
 
-    [[nodiscard]] std::vector<std::string> getClasses() const {
+    [[nodiscard]] const std::pmr::vector<StringView> &getClasses() const {
+        parseClassesIfNeeded();
         return this->clazz;
     }
 
 
-    [[nodiscard]] size_t getPairContentStartIndex() const {
+    [[nodiscard]] uint64_t getPairContentStartIndex() const {
         return pairContentStartIndex;
     }
 
 
-    [[nodiscard]] size_t getPairContentEndIndex() const {
+    [[nodiscard]] uint64_t getPairContentEndIndex() const {
         return pairContentEndIndex;
     }
 
@@ -110,6 +192,74 @@ public:
     [[nodiscard]] bool isSingleTag() const {
         return this->isSingle;
     }
+
+
+    /**
+     * Copies body of the tag and points tag, body, attributes and classes to the copy, so the tag
+     * stays valid after the content it was pointing to is released. Does nothing when tag already
+     * owns its body.
+     * @since 1.0.0
+     */
+    void ownBody() {
+        if (this->ownedBody != nullptr) {
+            return;
+        }
+        auto newBody = std::make_shared<const String>(this->body);
+        const CharT *oldData = this->body.data();
+        const CharT *newData = newBody->data();
+        size_t length = this->body.length();
+        auto rebase = [oldData, newData, length](const StringView &view) -> StringView {
+            if (view.data() < oldData || view.data() + view.length() > oldData + length) {
+                //Not a view into the body, e.g. empty attribute value
+                return view;
+            }
+            return {newData + (view.data() - oldData), view.length()};
+        };
+
+        this->tag = rebase(this->tag);
+        //Attributes are stored as offsets within the body
+        this->attributes.rebase(newData);
+        for (StringView &clazzName: this->clazz) {
+            clazzName = rebase(clazzName);
+        }
+        this->body = StringView(*newBody);
+        this->ownedBody = std::move(newBody);
+    }
+
+
+private:
+
+
+    /**
+     * Parses attributes from body on the first call, result is cached for next calls.
+     * @since 1.0.0
+     */
+    void parseAttributesIfNeeded() const {
+        if (this->isAttributesParsed) {
+            return;
+        }
+        this->attributes.parse(this->body);
+        this->isAttributesParsed = true;
+    }
+
+
+    /**
+     * Parses classes from class attribute on the first call, result is cached for next calls.
+     * @since 1.0.0
+     */
+    void parseClassesIfNeeded() const {
+        if (this->isClassesParsed) {
+            return;
+        }
+        StringView classAttribute = getAttribute(htmlNames::AttributeId::CLASS);
+        if (!classAttribute.empty()) {
+            htmlUtils::extractClassesFromString(classAttribute, this->clazz);
+        }
+        this->isClassesParsed = true;
+    }
 };
 
+
+using TagInfo = BasicTagInfo<char>;
+
 #endif //ANDROID_HTML_ITERATOR_TAGINFO_H
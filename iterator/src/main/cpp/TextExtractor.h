@@ -0,0 +1,182 @@
+#include <string>
+#include "HtmlNames.h"
+#include "StringUtils.h"
+#include "TagInfo.h"
+
+#ifndef ANDROID_HTML_ITERATOR_TEXTEXTRACTOR_H
+#define ANDROID_HTML_ITERATOR_TEXTEXTRACTOR_H
+
+
+/**
+ * Builds plain visible text of the content for <code>BasicHtmlIterator::extractText</code>. Texts
+ * are appended already normalized by iterator, extractor only puts line and paragraph breaks
+ * between texts of block tags, so whole text is written into single buffer.
+ * @since 1.0.0
+ */
+template<typename CharT>
+class BasicTextExtractor {
+
+public:
+    using String = std::basic_string<CharT>;
+    using TagInfo = BasicTagInfo<CharT>;
+
+
+private:
+
+    /**
+     * Breaks ordered by strength, stronger break wins when several boundaries meet between texts.
+     * @since 1.0.0
+     */
+    enum Break : uint8_t {
+        BREAK_NONE = 0,
+        BREAK_LINE = 1,
+        BREAK_PARAGRAPH = 2,
+    };
+
+
+    String text;
+
+
+    /**
+     * Break to be written before the next text, breaks are never written at the start or at the end
+     * of the text.
+     * @since 1.0.0
+     */
+    Break pendingBreak = BREAK_NONE;
+
+
+public:
+
+    /**
+     * @param tag Pair tag found by iterator.
+     * @return True when content of the tag is never visible, so iterator can skip it.
+     * @since 1.0.0
+     */
+    [[nodiscard]] static bool isHiddenTag(const TagInfo &tag) {
+        switch (tag.getTagId()) {
+            case htmlNames::TagId::STYLE:
+            case htmlNames::TagId::TEMPLATE:
+            case htmlNames::TagId::NOSCRIPT:
+            case htmlNames::TagId::TITLE:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+
+    /**
+     * Called when iterator enters or leaves tag, <code>&lt;br&gt;</code> and block tags are
+     * breaking the text.
+     * @since 1.0.0
+     */
+    void onTagBoundary(const TagInfo &tag) {
+        Break tagBreak = getBreak(tag.getTagId());
+        if (tagBreak > pendingBreak) {
+            pendingBreak = tagBreak;
+        }
+    }
+
+
+    /**
+     * Appends text delivered by iterator.
+     * @param newText Text normalized by iterator.
+     * @param isPreformatted True when text is from <code>&lt;pre&gt;</code> tag, so its white chars
+     * are kept.
+     * @since 1.0.0
+     */
+    void appendText(
+            const String &newText,
+            bool isPreformatted
+    ) {
+        size_t s = 0;
+        if (pendingBreak != BREAK_NONE) {
+            while (stringUtils::endsWith(text, ' ')) {
+                text.pop_back();
+            }
+            if (!text.empty()) {
+                text.append(pendingBreak == BREAK_PARAGRAPH ? 2 : 1, '\n');
+            }
+            pendingBreak = BREAK_NONE;
+            //Text on new line starts without space, first line break of <pre> is not visible too
+            CharT skippedChar = isPreformatted ? '\n' : ' ';
+            if (!newText.empty() && newText[0] == skippedChar) {
+                s = 1;
+            }
+        } else if (text.empty() && !isPreformatted && stringUtils::startsWith(newText, ' ')) {
+            s = 1;
+        }
+        text.append(newText, s, String::npos);
+    }
+
+
+    /**
+     * @return Extracted text without trailing white chars, extractor is cleared.
+     * @since 1.0.0
+     */
+    String takeText() {
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\n')) {
+            text.pop_back();
+        }
+        String result = std::move(text);
+        clear();
+        return result;
+    }
+
+
+    void clear() {
+        text.clear();
+        pendingBreak = BREAK_NONE;
+    }
+
+
+private:
+
+    [[nodiscard]] static Break getBreak(htmlNames::TagId tagId) {
+        switch (tagId) {
+            case htmlNames::TagId::BR:
+            case htmlNames::TagId::DIV:
+            case htmlNames::TagId::LI:
+            case htmlNames::TagId::DT:
+            case htmlNames::TagId::DD:
+            case htmlNames::TagId::TR:
+            case htmlNames::TagId::CAPTION:
+            case htmlNames::TagId::FIGCAPTION:
+            case htmlNames::TagId::LEGEND:
+            case htmlNames::TagId::OPTION:
+            case htmlNames::TagId::SUMMARY:
+                return BREAK_LINE;
+            case htmlNames::TagId::P:
+            case htmlNames::TagId::H1:
+            case htmlNames::TagId::H2:
+            case htmlNames::TagId::H3:
+            case htmlNames::TagId::H4:
+            case htmlNames::TagId::H5:
+            case htmlNames::TagId::H6:
+            case htmlNames::TagId::HR:
+            case htmlNames::TagId::PRE:
+            case htmlNames::TagId::BLOCKQUOTE:
+            case htmlNames::TagId::ADDRESS:
+            case htmlNames::TagId::ARTICLE:
+            case htmlNames::TagId::ASIDE:
+            case htmlNames::TagId::DETAILS:
+            case htmlNames::TagId::DL:
+            case htmlNames::TagId::FIELDSET:
+            case htmlNames::TagId::FIGURE:
+            case htmlNames::TagId::FOOTER:
+            case htmlNames::TagId::FORM:
+            case htmlNames::TagId::HEADER:
+            case htmlNames::TagId::MAIN:
+            case htmlNames::TagId::NAV:
+            case htmlNames::TagId::OL:
+            case htmlNames::TagId::SECTION:
+            case htmlNames::TagId::TABLE:
+            case htmlNames::TagId::UL:
+                return BREAK_PARAGRAPH;
+            default:
+                return BREAK_NONE;
+        }
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_TEXTEXTRACTOR_H
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifndef ANDROID_HTML_ITERATOR_WORKSTEALINGPOOL_H
+#define ANDROID_HTML_ITERATOR_WORKSTEALINGPOOL_H
+
+
+/**
+ * Pool of workers processing batch of tasks identified by index. Every worker gets its own queue
+ * with continuous range of tasks, it takes tasks from the front of its queue and when the queue is
+ * empty, it steals tasks from the back of other queues. Tasks of different sizes (e.g. short and
+ * long documents) are so balanced between workers, while each worker mostly works on neighbouring
+ * tasks.
+ * @since 1.0.0
+ */
+class WorkStealingPool {
+
+private:
+
+    /**
+     * Queue of task indexes owned by single worker.
+     * @since 1.0.0
+     */
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+
+    /**
+     * Queues of workers, index of the queue is index of the worker.
+     * @since 1.0.0
+     */
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+
+
+public:
+
+    /**
+     * @param workersCount Count of workers, 0 to use count of cores.
+     * @since 1.0.0
+     */
+    explicit WorkStealingPool(size_t workersCount = 0) {
+        if (workersCount == 0) {
+            workersCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < workersCount; i++) {
+            queues.push_back(std::make_unique<TaskQueue>());
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+
+    /**
+     * @return Count of workers.
+     * @since 1.0.0
+     */
+    size_t getWorkersCount() const {
+        return queues.size();
+    }
+
+
+    /**
+     * Splits tasks <code>[0, tasksCount)</code> into queues of workers and runs
+     * <code>worker(workerIndex)</code> for every worker. Worker 0 runs on calling thread, others on
+     * new threads. Returns after all workers returned. Worker is expected to loop over
+     * <code>takeTask</code> until it returns false, so tasks of worker whose thread can't be started
+     * are taken by other workers. Exception thrown by worker 0 is rethrown after other workers
+     * returned.
+     * @param tasksCount Count of tasks.
+     * @param worker Function of worker, called once per worker.
+     * @since 1.0.0
+     */
+    template<typename Worker>
+    void run(size_t tasksCount, Worker worker) {
+        size_t workersCount = std::min(queues.size(), std::max<size_t>(tasksCount, 1));
+        for (size_t i = 0; i < queues.size(); i++) {
+            TaskQueue &queue = *queues[i];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.clear();
+            if (i >= workersCount) {
+                continue;
+            }
+            size_t start = i * tasksCount / workersCount;
+            size_t end = (i + 1) * tasksCount / workersCount;
+            for (size_t task = start; task < end; task++) {
+                queue.tasks.push_back(task);
+            }
+        }
+
+        std::vector<std::thread> threads;
+        try {
+            threads.reserve(workersCount - 1);
+            for (size_t i = 1; i < workersCount; i++) {
+                try {
+                    threads.emplace_back(worker, i);
+                } catch (const std::system_error &) {
+                    //Thread can't be started, its tasks are stolen by running workers
+                    break;
+                }
+            }
+            worker(0);
+        } catch (...) {
+            //Started workers use the queues and the worker, they must not outlive this call
+            joinAll(threads);
+            throw;
+        }
+        joinAll(threads);
+    }
+
+
+    /**
+     * Takes next task for worker, from its own queue first, stolen from other queue otherwise.
+     * @param workerIndex Index of worker taking the task.
+     * @param outTask Index of taken task.
+     * @return True when task was taken, false when all tasks were taken.
+     * @since 1.0.0
+     */
+    bool takeTask(size_t workerIndex, size_t &outTask) {
+        {
+            TaskQueue &ownQueue = *queues[workerIndex];
+            std::lock_guard<std::mutex> lock(ownQueue.mutex);
+            if (!ownQueue.tasks.empty()) {
+                outTask = ownQueue.tasks.front();
+                ownQueue.tasks.pop_front();
+                return true;
+            }
+        }
+
+        for (size_t offset = 1; offset < queues.size(); offset++) {
+            TaskQueue &victimQueue = *queues[(workerIndex + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(victimQueue.mutex);
+            if (!victimQueue.tasks.empty()) {
+                //Stealing from the back, owner of the queue continues from the front
+                outTask = victimQueue.tasks.back();
+                victimQueue.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+private:
+
+    /**
+     * Waits for all threads to finish.
+     * @since 1.0.0
+     */
+    static void joinAll(std::vector<std::thread> &threads) {
+        for (std::thread &thread: threads) {
+            thread.join();
+        }
+    }
+};
+
+#endif //ANDROID_HTML_ITERATOR_WORKSTEALINGPOOL_H
@@ -0,0 +1,279 @@
+package com.htmliterator
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.CharBuffer
+
+
+/**
+ * Decodes batches of events written by native iterator and dispatches them to [callback], so java
+ * is called once per batch instead of once per result. Layout of events has to match
+ * JniEventBatchCallback.h. Native iterator iterates content of every pair tag, so when
+ * [HtmlIterator.Callback.onPairTag] returns false, events within the tag are dropped here and only
+ * [HtmlIterator.Callback.onLeavingPairTag] of the tag is delivered. Refused tag is so left where
+ * iteration closes it, e.g. tag containing script with the tag name in a string is closed by its
+ * real closing tag.
+ * @since 1.0.0
+ */
+internal class EventBatchDecoder internal constructor(
+    private val callback: HtmlIterator.Callback,
+) {
+
+
+    private companion object {
+        const val EVENT_STRING: Int = 0
+        const val EVENT_TEXT: Int = 1
+        const val EVENT_SINGLE_TAG: Int = 2
+        const val EVENT_PAIR_TAG: Int = 3
+        const val EVENT_LEAVING_PAIR_TAG: Int = 4
+        const val EVENT_SCRIPT: Int = 5
+        const val EVENT_LEFT_PAIR_TAG_TEXT: Int = 6
+
+        const val FLAG_UTF_16: Int = 1
+        const val FLAG_NEW_CONTENT: Int = 2
+    }
+
+
+    /**
+     * Table of strings of current batch, see EVENT_STRING.
+     */
+    private val strings: ArrayList<String> = ArrayList()
+
+
+    /**
+     * Pair tags not left yet, passed to [HtmlIterator.Callback.onLeavingPairTag].
+     */
+    private val pairTags: ArrayList<TagInfo> = ArrayList()
+
+
+    /**
+     * Depth of pair tags within tag refused by [HtmlIterator.Callback.onPairTag], including the
+     * refused one. Events are dropped while it's greater than 0.
+     */
+    private var skippedDepth: Int = 0
+
+
+    /**
+     * True right after refused tag was left. Text at the end of the tag is delivered after the tag is
+     * left as EVENT_LEFT_PAIR_TAG_TEXT, so such event right after leaving belongs to the refused tag
+     * and it's dropped.
+     */
+    private var isDroppingText: Boolean = false
+
+
+    private var chars: CharArray = CharArray(size = 256)
+    private var bytes: ByteArray = ByteArray(size = 256)
+
+
+    private lateinit var buffer: ByteBuffer
+    private lateinit var charBuffer: CharBuffer
+    private var position: Int = 0
+    private var isUtf16: Boolean = false
+
+
+    /**
+     * Called by native iterator with batch of events in [buffer] from 0 to [length].
+     */
+    fun onEvents(
+        buffer: ByteBuffer,
+        length: Int,
+        flags: Int,
+    ): Unit {
+        if (flags and FLAG_NEW_CONTENT != 0) {
+            pairTags.clear()
+            skippedDepth = 0
+            isDroppingText = false
+        }
+        this.buffer = buffer.order(ByteOrder.nativeOrder())
+        this.isUtf16 = flags and FLAG_UTF_16 != 0
+        if (isUtf16) {
+            buffer.position(0)
+            charBuffer = buffer.asCharBuffer()
+        }
+        position = 0
+        strings.clear()
+
+        try {
+            while (position < length) {
+                val type = readInt()
+                if (type == EVENT_LEFT_PAIR_TAG_TEXT && isDroppingText) {
+                    isDroppingText = false
+                    skipString()
+                    continue
+                }
+                if (type != EVENT_STRING) {
+                    isDroppingText = false
+                }
+                when (type) {
+                    EVENT_STRING -> strings.add(element = readString())
+                    EVENT_TEXT, EVENT_LEFT_PAIR_TAG_TEXT -> onText()
+                    EVENT_SINGLE_TAG -> onTag(isScript = false)
+                    EVENT_SCRIPT -> onTag(isScript = true)
+                    EVENT_PAIR_TAG -> onPairTag()
+                    EVENT_LEAVING_PAIR_TAG -> onLeavingPairTag()
+                    else -> throw IllegalStateException("Unknown event $type")
+                }
+            }
+        } catch (exception: Throwable) {
+            //Native iterator drops the rest of the content, so state is not valid anymore
+            pairTags.clear()
+            skippedDepth = 0
+            isDroppingText = false
+            throw exception
+        }
+    }
+
+
+    private fun onText() {
+        if (skippedDepth > 0) {
+            skipString()
+            return
+        }
+        callback.onContentText(text = readString())
+    }
+
+
+    private fun onTag(isScript: Boolean) {
+        if (skippedDepth > 0) {
+            skipTag()
+            return
+        }
+        val tag = readTag()
+        if (isScript) {
+            callback.onScript(tag = tag)
+        } else {
+            callback.onSingleTag(tag = tag)
+        }
+    }
+
+
+    private fun onPairTag() {
+        if (skippedDepth > 0) {
+            skipTag()
+            position += 4 * Long.SIZE_BYTES
+            skippedDepth += 1
+            return
+        }
+        val tag = readTag()
+        pairTags.add(element = tag)
+        val isSteppingInto = callback.onPairTag(
+            tag = tag,
+            openingTagStartIndex = readLong(),
+            openingTagEndIndex = readLong(),
+            closingTagStartIndex = readLong(),
+            closingTagEndIndex = readLong(),
+        )
+        if (!isSteppingInto) {
+            skippedDepth = 1
+        }
+    }
+
+
+    private fun onLeavingPairTag() {
+        if (skippedDepth > 1) {
+            position += 2 * Long.SIZE_BYTES
+            skippedDepth -= 1
+            return
+        }
+        isDroppingText = skippedDepth == 1
+        skippedDepth = 0
+        if (pairTags.isEmpty()) {
+            position += 2 * Long.SIZE_BYTES
+            return
+        }
+        val tag = pairTags.removeAt(index = pairTags.lastIndex)
+        callback.onLeavingPairTag(
+            tag = tag,
+            closingTagStartIndex = readLong(),
+            closingTagEndIndex = readLong(),
+        )
+    }
+
+
+    private fun readTag(): TagInfo {
+        val name = strings[readInt()]
+        val isSingle = readInt() != 0
+        val body = readString()
+        val attributesCount = readInt()
+        val attributes = HashMap<String, String>(attributesCount * 2)
+        repeat(times = attributesCount) {
+            val attributeName = strings[readInt()]
+            attributes[attributeName] = readString()
+        }
+        val classesCount = readInt()
+        val classes = ArrayList<String>(classesCount)
+        repeat(times = classesCount) {
+            classes.add(element = readString())
+        }
+        return TagInfo(
+            tag = name,
+            body = body,
+            attributes = attributes,
+            classes = classes,
+            isSingle = isSingle,
+        )
+    }
+
+
+    private fun skipTag() {
+        position += 2 * Int.SIZE_BYTES
+        skipString()
+        repeat(times = readInt()) {
+            position += Int.SIZE_BYTES
+            skipString()
+        }
+        repeat(times = readInt()) {
+            skipString()
+        }
+    }
+
+
+    private fun readInt(): Int {
+        val value = buffer.getInt(position)
+        position += Int.SIZE_BYTES
+        return value
+    }
+
+
+    private fun readLong(): Long {
+        val value = buffer.getLong(position)
+        position += Long.SIZE_BYTES
+        return value
+    }
+
+
+    private fun readString(): String {
+        val length = readInt()
+        val string = if (isUtf16) {
+            if (chars.size < length) {
+                chars = CharArray(size = maxOf(length, chars.size * 2))
+            }
+            charBuffer.position(position / Char.SIZE_BYTES)
+            charBuffer.get(chars, 0, length)
+            String(chars, 0, length)
+        } else {
+            if (bytes.size < length) {
+                bytes = ByteArray(size = maxOf(length, bytes.size * 2))
+            }
+            buffer.position(position)
+            buffer.get(bytes, 0, length)
+            String(bytes, 0, length, Charsets.UTF_8)
+        }
+        position += alignedSize(length = length)
+        return string
+    }
+
+
+    private fun skipString() {
+        position += alignedSize(length = readInt())
+    }
+
+
+    /**
+     * @return Size of string of [length] code units in bytes, strings are aligned to 4 bytes.
+     */
+    private fun alignedSize(length: Int): Int {
+        val size = if (isUtf16) length * Char.SIZE_BYTES else length
+        return (size + 3) and 3.inv()
+    }
+}
@@ -0,0 +1,21 @@
+package com.htmliterator
+
+
+/**
+ * Filter of results evaluated by native iterator before results are passed to java, so results
+ * which are filtered out cost no call into java nor any object. Set it by [HtmlIterator.setFilter].
+ * Tag and attribute names are matched ignoring case.
+ * @param tagNames Names of tags delivered to the callback, all tags are delivered when empty.
+ * Content of other pair tags is still iterated, so text and tags nested in them are delivered.
+ * @param skippedTagNames Names of pair tags whose content is skipped without being iterated, tags
+ * themselves are not delivered either. Single tags and scripts of these names are not delivered.
+ * @param isTextReported False when [HtmlIterator.Callback.onContentText] is never called.
+ * @param requiredAttributes Names of attributes tag must have to be delivered.
+ * @since 1.0.0
+ */
+data class EventFilter constructor(
+    val tagNames: Set<String> = emptySet(),
+    val skippedTagNames: Set<String> = emptySet(),
+    val isTextReported: Boolean = true,
+    val requiredAttributes: Set<String> = emptySet(),
+)
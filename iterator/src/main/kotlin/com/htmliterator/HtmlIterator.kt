@@ -8,16 +8,21 @@ package com.htmliterator
 
 import androidx.annotation.CallSuper
 import androidx.annotation.RestrictTo
+import dalvik.annotation.optimization.FastNative
+import java.io.Closeable
+import java.nio.ByteBuffer
 import java.util.Stack
 
 
 /**
+ * Iterator backed by its own native iterator, so different instances can iterate different contents
+ * on different threads at once. Single instance must not be used from more threads at once. Call
+ * [close] when instance is no longer needed to free the native iterator.
  * @author Miroslav Hýbler <br>
  * created on 22.11.2024
  * @since 1.0.0
  */
-//TODO make object, doensn't make sense to have it as class
-public class HtmlIterator private constructor() {
+public class HtmlIterator public constructor() : Closeable {
 
 
     public companion object {
@@ -28,13 +33,21 @@ public class HtmlIterator private constructor() {
 
 
         /**
-         * Default instance of [com.htmliterator.HtmlIterator]
+         * Default instance of [com.htmliterator.HtmlIterator] shared by whole process, never close it.
+         * Create own instance for iterating on other threads.
          * @since 1.0.0
          */
         public val instance: HtmlIterator = HtmlIterator()
     }
 
 
+    /**
+     * Pointer to native iterator, read by native code. 0 when iterator was closed.
+     * @since 1.0.0
+     */
+    private var nativeHandle: Long = createNativeHandle()
+
+
     /**
      *
      */
@@ -42,8 +55,34 @@ public class HtmlIterator private constructor() {
         get() = getIsContentFullHtmlDocument()
 
 
+    /**
+     * When true, closing tag indexes are available already in [Callback.onPairTag], index of closing
+     * tags is built in one extra pass through the content. When false (default), pair tags are matched
+     * in single pass and closing tag indexes in [Callback.onPairTag] are -1, they are delivered in
+     * [Callback.onLeavingPairTag] instead.
+     * @since 1.0.0
+     */
+    public var isClosingTagIndexEnabled: Boolean
+        get() = getIsClosingTagIndexEnabled()
+        set(value) = setIsClosingTagIndexEnabled(isEnabled = value)
+
+
+    /**
+     * When true (default), content of at least 1 MB set by [setContent] is lexed in parallel on
+     * threads for all cores before it's iterated. Disable it when iterators are already running in
+     * parallel, e.g. on own pool of threads. Has effect for the next content, documents of
+     * [iterateBatch] are never lexed in parallel.
+     * @since 1.0.0
+     */
+    public var isParallelTokenizationEnabled: Boolean
+        get() = getIsParallelTokenizationEnabled()
+        set(value) = setIsParallelTokenizationEnabled(isEnabled = value)
+
+
     /**
      * Sets content to native iterator. Don't forget to call [setContent] before [iterate].
+     * [content] is iterated as UTF-16 without converting it, so indexes delivered to the callback
+     * are indexes of chars in [content], e.g. usable with [String.substring].
      * @since 1.0.0
      */
     external fun setContent(
@@ -51,6 +90,93 @@ public class HtmlIterator private constructor() {
     ): Unit
 
 
+    /**
+     * Sets UTF-8 encoded content between [ByteBuffer.position] and [ByteBuffer.limit] of direct
+     * [buffer] to native iterator without copying it. Iterator borrows the [buffer], so its content
+     * must not be changed until another content is set.
+     * @throws IllegalArgumentException when [buffer] is not direct.
+     * @since 1.0.0
+     */
+    fun setContent(
+        buffer: ByteBuffer,
+    ): Unit {
+        require(value = buffer.isDirect) { "Only direct buffer can be borrowed by iterator" }
+        setContentFromBuffer(
+            buffer = buffer,
+            offset = buffer.position(),
+            length = buffer.remaining(),
+        )
+    }
+
+
+    /**
+     * Sets UTF-8 encoded content of [bytes] from [offset] with [length] to native iterator.
+     * Iterator borrows [bytes] instead of copying them when runtime allows it, so [bytes] must not
+     * be changed until another content is set.
+     * @throws IndexOutOfBoundsException when [offset] and [length] are out of [bytes].
+     * @since 1.0.0
+     */
+    fun setContent(
+        bytes: ByteArray,
+        offset: Int = 0,
+        length: Int = bytes.size - offset,
+    ): Unit {
+        if (offset < 0 || length < 0 || offset > bytes.size - length) {
+            throw IndexOutOfBoundsException(
+                "offset: $offset, length: $length, size: ${bytes.size}"
+            )
+        }
+        setContentFromBytes(bytes = bytes, offset = offset, length = length)
+    }
+
+
+    /**
+     * Sets content of the file at [path] to native iterator, alternative to [setContent] for big
+     * files. File is memory mapped and iterated without copying it into memory, so it must not be
+     * changed until another content is set.
+     * @return True when content was set, false when file can't be opened.
+     * @since 1.0.0
+     */
+    external fun setContentFromFile(
+        path: String,
+    ): Boolean
+
+
+    /**
+     * Same as [setContentFromFile] for file opened by [fd], e.g. from
+     * [android.os.ParcelFileDescriptor.getFd]. Descriptor stays owned by caller and can be closed
+     * right after the call.
+     * @return True when content was set, false when file can't be mapped.
+     * @since 1.0.0
+     */
+    external fun setContentFromFileDescriptor(
+        fd: Int,
+    ): Boolean
+
+
+    /**
+     * Appends next [chunk] of streamed content, e.g. as it's received from network, and delivers all
+     * complete steps to the callback right away, so [setCallback] has to be called before. Incomplete
+     * tag, comment or script at the end of the [chunk] is kept and delivered with next chunk. First
+     * call after [setContent] or [finish] starts new content. Call [finish] after the last chunk.
+     *
+     * Indexes delivered to the callback are char indexes relative to the whole streamed content.
+     * [isClosingTagIndexEnabled] has no effect for streamed content.
+     * @since 1.0.0
+     */
+    external fun feed(
+        chunk: String,
+    ): Unit
+
+
+    /**
+     * Marks content streamed by [feed] as complete and delivers the rest of the steps, unclosed
+     * pair tags are left.
+     * @since 1.0.0
+     */
+    external fun finish(): Unit
+
+
     /**
      * Sets [callback] to iterator.
      * @since 1.0.0
@@ -60,6 +186,70 @@ public class HtmlIterator private constructor() {
     ): Unit
 
 
+    /**
+     * Sets [callback] to iterator, results are delivered to it in batches of [maxEventsCount]
+     * instead of crossing from native code to java for every single result. Callback gets the same
+     * results in the same order as with [setCallback], but batch is delivered only when it's full or
+     * when [iterate], [iterateSingleStep], [feed] or [finish] returns, so results are not delivered
+     * right as they are found. Content of pair tag refused by [Callback.onPairTag] is still iterated
+     * by native iterator, only its results are dropped, so whitespace of text following the tag is
+     * adjusted as if the content was delivered.
+     * @since 1.0.0
+     */
+    fun <C : Callback> setBatchedCallback(
+        callback: C,
+        maxEventsCount: Int = 1000,
+    ): Unit {
+        require(value = maxEventsCount > 0) { "maxEventsCount must be positive" }
+        setEventBatchDecoder(
+            decoder = EventBatchDecoder(callback = callback),
+            maxEventsCount = maxEventsCount,
+        )
+    }
+
+
+    /**
+     * Sets [filter] evaluated by native iterator before results are delivered to the callback, so
+     * only results the callback is interested in are passed to java. Filter applies to callbacks set
+     * by [setCallback] and [setBatchedCallback] and to [iterateBatch]. Filter has to be set before
+     * content is iterated, changing it in the middle of the content may leave pair tags delivered
+     * by [Callback.onPairTag] without [Callback.onLeavingPairTag].
+     * @param filter New filter, null to deliver all results.
+     * @since 1.0.0
+     */
+    fun setFilter(
+        filter: EventFilter?,
+    ): Unit {
+        val actualFilter = filter ?: EventFilter()
+        setEventFilter(
+            tagNames = actualFilter.tagNames.toTypedArray(),
+            skippedTagNames = actualFilter.skippedTagNames.toTypedArray(),
+            isTextReported = actualFilter.isTextReported,
+            requiredAttributes = actualFilter.requiredAttributes.toTypedArray(),
+        )
+    }
+
+
+    /**
+     * Replaces callback by native matching of CSS [selectors], only matching elements are passed to
+     * [callback], so there is no need to track [Callback.tagStack] in java. Supported are type,
+     * universal, id, class and attribute selectors, `:nth-child()`, descendant and child combinators
+     * and selector lists separated by comma. Matching of whole content is done in single pass, pair
+     * tags are matched when they are left, so nested matches are delivered before their ancestors.
+     * [filter][setFilter] applies to selectors too, tags dropped by it can't be matched.
+     * @param selectors Selectors, index of the selector is passed to [SelectorCallback.onMatch].
+     * @param callback Callback getting matching elements.
+     * @throws IllegalArgumentException When selector is not valid or is not supported.
+     * @since 1.0.0
+     */
+    fun setSelectorCallback(
+        selectors: List<String>,
+        callback: SelectorCallback,
+    ): Unit {
+        setSelectors(selectors = selectors.toTypedArray(), callback = callback)
+    }
+
+
     /**
      * @since 1.0.0
      */
@@ -67,11 +257,62 @@ public class HtmlIterator private constructor() {
 
 
     /**
+     * Iterates content set by [setContent] and returns its visible text in single call, instead of
+     * delivering results to callback one by one, so there is no need to set callback. Texts are
+     * normalized the same way as texts delivered by [Callback.onContentText], texts of block tags
+     * are separated by line or paragraph breaks. Scripts, styles and other hidden content are
+     * skipped. Useful when only plain text is needed, e.g. for search indexing or previews.
+     * @return Plain text of the content.
      * @since 1.0.0
      */
+    external fun extractText(): String
+
+
+    /**
+     * Called in loops step by step, so it's bound as [FastNative] to cut transition cost of the call.
+     * @since 1.0.0
+     */
+    @FastNative
     external fun iterateSingleStep(): Boolean
 
 
+    /**
+     * Iterates all [documents] in parallel on pool of threads sized to count of cores, calling
+     * thread is one of them and returns when all documents are iterated. Every document gets its
+     * own callback created by [callbackFactory] with index of the document. Callbacks are called
+     * on pool threads as documents are iterated, so documents are completed in any order, but
+     * every callback gets steps of its document in order. Content and callback of this iterator
+     * are not used nor changed, only [isClosingTagIndexEnabled] and filter set by [setFilter] are
+     * applied.
+     * @throws Throwable first exception thrown by any callback or [callbackFactory], remaining
+     * documents are not iterated then.
+     * @since 1.0.0
+     */
+    fun iterateBatch(
+        documents: List<String>,
+        callbackFactory: CallbackFactory,
+    ): Unit {
+        iterateDocuments(
+            documents = documents.toTypedArray(),
+            callbackFactory = callbackFactory,
+        )
+    }
+
+
+    /**
+     * Frees native iterator, any other call after [close] throws [IllegalStateException]. Calling
+     * [close] again has no effect.
+     * @since 1.0.0
+     */
+    override fun close(): Unit {
+        val handle = nativeHandle
+        if (handle != 0L) {
+            nativeHandle = 0L
+            destroyNativeHandle(nativeHandle = handle)
+        }
+    }
+
+
     /**
      * @since 1.0.0
      */
@@ -81,14 +322,180 @@ public class HtmlIterator private constructor() {
     ): Unit
 
 
+    /**
+     * Use [setContent] with [ByteBuffer].
+     * @return False when [buffer] is not direct.
+     * @since 1.0.0
+     */
+    @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
+    external fun setContentFromBuffer(
+        buffer: ByteBuffer,
+        offset: Int,
+        length: Int,
+    ): Boolean
+
+
+    /**
+     * Use [setContent] with [ByteArray].
+     * @since 1.0.0
+     */
+    @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
+    external fun setContentFromBytes(
+        bytes: ByteArray,
+        offset: Int,
+        length: Int,
+    ): Unit
+
+
+    /**
+     * Creates native iterator for [nativeHandle].
+     * @since 1.0.0
+     */
+    private external fun createNativeHandle(): Long
+
+
+    /**
+     * Use [close].
+     * @since 1.0.0
+     */
+    private external fun destroyNativeHandle(
+        nativeHandle: Long,
+    ): Unit
+
+
+    /**
+     * Use [setBatchedCallback].
+     * @since 1.0.0
+     */
+    private external fun setEventBatchDecoder(
+        decoder: EventBatchDecoder,
+        maxEventsCount: Int,
+    ): Unit
+
+
+    /**
+     * Use [setFilter].
+     * @since 1.0.0
+     */
+    private external fun setEventFilter(
+        tagNames: Array<String>,
+        skippedTagNames: Array<String>,
+        isTextReported: Boolean,
+        requiredAttributes: Array<String>,
+    ): Unit
+
+
+    /**
+     * Use [setSelectorCallback].
+     * @since 1.0.0
+     */
+    private external fun setSelectors(
+        selectors: Array<String>,
+        callback: SelectorCallback,
+    ): Unit
+
+
+    /**
+     * Use [iterateBatch].
+     * @since 1.0.0
+     */
+    @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
+    external fun iterateDocuments(
+        documents: Array<String>,
+        callbackFactory: CallbackFactory,
+    ): Unit
+
+
     /**
      * Use [isContentFullHtmlDocument].
      * @since 1.0.0
      */
+    @FastNative
     @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
     external fun getIsContentFullHtmlDocument(): Boolean
 
 
+    /**
+     * Use [isClosingTagIndexEnabled].
+     * @since 1.0.0
+     */
+    @FastNative
+    @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
+    external fun setIsClosingTagIndexEnabled(
+        isEnabled: Boolean,
+    ): Unit
+
+
+    /**
+     * Use [isClosingTagIndexEnabled].
+     * @since 1.0.0
+     */
+    @FastNative
+    @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
+    external fun getIsClosingTagIndexEnabled(): Boolean
+
+
+    /**
+     * Use [isParallelTokenizationEnabled].
+     * @since 1.0.0
+     */
+    @FastNative
+    @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
+    external fun setIsParallelTokenizationEnabled(
+        isEnabled: Boolean,
+    ): Unit
+
+
+    /**
+     * Use [isParallelTokenizationEnabled].
+     * @since 1.0.0
+     */
+    @FastNative
+    @RestrictTo(RestrictTo.Scope.LIBRARY_GROUP)
+    external fun getIsParallelTokenizationEnabled(): Boolean
+
+
+    /**
+     * Gets elements matching selectors set by [setSelectorCallback].
+     * @since 1.0.0
+     */
+    fun interface SelectorCallback {
+
+        /**
+         * Called when element matches selector. [tag] is backed by native tag and valid only during
+         * the call, use [TagInfo.detach] to keep it.
+         * @param tag Matching tag.
+         * @param selectorIndex Index of matched selector in selectors passed to [setSelectorCallback].
+         * @param contentStartIndex Index of the first char of the content of the tag, -1 for single
+         * tag.
+         * @param contentEndIndex Index of '<' of closing tag, -1 for single tag.
+         * @since 1.0.0
+         */
+        fun onMatch(
+            tag: TagInfo,
+            selectorIndex: Int,
+            contentStartIndex: Long,
+            contentEndIndex: Long,
+        )
+    }
+
+
+    /**
+     * Creates callback for every document iterated by [iterateBatch]. Called on pool threads, so it
+     * must be thread safe.
+     * @since 1.0.0
+     */
+    fun interface CallbackFactory {
+
+        /**
+         * @param documentIndex Index of the document in documents passed to [iterateBatch].
+         * @return New callback for the document.
+         * @since 1.0.0
+         */
+        fun createCallback(documentIndex: Int): Callback
+    }
+
+
     /**
      * @since 1.0.0
      */
@@ -103,6 +510,8 @@ public class HtmlIterator private constructor() {
             private set
 
         /**
+         * Text between tags, white chars are collapsed outside of `<pre>` tag and character
+         * references like `&amp;` or `&#x2014;` are decoded.
          * @since 1.0.0
          */
         open fun onContentText(
@@ -119,16 +528,22 @@ public class HtmlIterator private constructor() {
 
 
         /**
+         * Indexes are [Long], so content of files bigger than 2 GB set by [setContentFromFile] can be
+         * indexed. Indexes are char indexes for [String] content and byte offsets for UTF-8 content
+         * set from file, [ByteBuffer] or [ByteArray].
+         * @param closingTagStartIndex Index of closing tag start, -1 unless
+         * [HtmlIterator.isClosingTagIndexEnabled] is true and the tag is closed.
+         * @param closingTagEndIndex Index of closing tag end, same rules as for [closingTagStartIndex].
          * @since 1.0.0
          */
         //TODO indexes maybe not necessary
         @CallSuper
         open fun onPairTag(
             tag: TagInfo,
-            openingTagStartIndex: Int,
-            openingTagEndIndex: Int,
-            closingTagStartIndex: Int,
-            closingTagEndIndex: Int,
+            openingTagStartIndex: Long,
+            openingTagEndIndex: Long,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
         ): Boolean {
             tagStack.add(element = tag)
             currentPairTag = tag
@@ -137,6 +552,19 @@ public class HtmlIterator private constructor() {
         }
 
 
+        /**
+         * Called with indexes of closing tag of the [tag]. When [tag] was never closed, indexes are
+         * pointing to closing tag of its parent or to the end of the content. Calls
+         * [onLeavingPairTag] without indexes by default.
+         * @since 1.0.0
+         */
+        open fun onLeavingPairTag(
+            tag: TagInfo,
+            closingTagStartIndex: Long,
+            closingTagEndIndex: Long,
+        ): Unit = onLeavingPairTag(tag = tag)
+
+
         /**
          * @since 1.0.0
          */
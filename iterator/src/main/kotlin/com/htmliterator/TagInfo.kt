@@ -1,26 +1,199 @@
-@file:Suppress("DATA_CLASS_COPY_VISIBILITY_WILL_BE_CHANGED_WARNING")
-
 package com.htmliterator
 
+import dalvik.annotation.optimization.FastNative
+
 
 /**
+ * Tag delivered to [HtmlIterator.Callback]. Tag delivered by native iterator is backed by native tag
+ * and [tag], [body], [attributes] and [classes] are created only when they are read for the first
+ * time, so tags which are only passed through cost single object. Native tag is valid only while the
+ * tag is delivered, single tags and scripts within their callback, pair tags until
+ * [HtmlIterator.Callback.onLeavingPairTag] of the tag returns. Values read before stay available,
+ * reading other values later throws [IllegalStateException]. Call [detach] to keep the tag longer.
  * @author Miroslav Hýbler <br>
  * created on 27.11.2024
  * @since 1.0.0
  */
-data class TagInfo internal constructor(
-    val tag: String,
-    val body: String,
-    val attributes: Map<String, String>,
-    val classes: List<String>,
-    val isSingle: Boolean
+class TagInfo private constructor(
+    nativeTag: Long,
+    private val isUtf16: Boolean,
+    tag: String?,
+    body: String?,
+    attributes: Map<String, String>?,
+    classes: List<String>?,
+    val isSingle: Boolean,
 ) {
 
 
     /**
-     * Tag body removed from string because it could mess up readability.
+     * Creates detached tag holding all of its values.
+     * @since 1.0.0
+     */
+    internal constructor(
+        tag: String,
+        body: String,
+        attributes: Map<String, String>,
+        classes: List<String>,
+        isSingle: Boolean,
+    ) : this(
+        nativeTag = 0L,
+        isUtf16 = false,
+        tag = tag,
+        body = body,
+        attributes = attributes,
+        classes = classes,
+        isSingle = isSingle,
+    )
+
+
+    /**
+     * Called by native code, creates tag backed by native tag.
+     * @since 1.0.0
+     */
+    private constructor(
+        nativeTag: Long,
+        isUtf16: Boolean,
+        isSingle: Boolean,
+    ) : this(
+        nativeTag = nativeTag,
+        isUtf16 = isUtf16,
+        tag = null,
+        body = null,
+        attributes = null,
+        classes = null,
+        isSingle = isSingle,
+    )
+
+
+    /**
+     * Pointer to native tag, cleared by native code when native tag is no longer valid. 0 for
+     * detached tag.
+     * @since 1.0.0
+     */
+    private var nativeTag: Long = nativeTag
+
+
+    private val isDetached: Boolean = nativeTag == 0L
+
+
+    private var cachedTag: String? = tag
+    private var cachedBody: String? = body
+    private var cachedAttributes: Map<String, String>? = attributes
+    private var cachedClasses: List<String>? = classes
+
+
+    val tag: String
+        get() = cachedTag
+            ?: nativeGetTag(nativeTag = requireNativeTag(), isUtf16 = isUtf16)
+                .also { value -> cachedTag = value }
+
+
+    val body: String
+        get() = cachedBody
+            ?: nativeGetBody(nativeTag = requireNativeTag(), isUtf16 = isUtf16)
+                .also { value -> cachedBody = value }
+
+
+    val attributes: Map<String, String>
+        get() = cachedAttributes
+            ?: nativeGetAttributes(nativeTag = requireNativeTag(), isUtf16 = isUtf16)
+                .also { value -> cachedAttributes = value }
+
+
+    val classes: List<String>
+        get() = cachedClasses
+            ?: nativeGetClasses(nativeTag = requireNativeTag(), isUtf16 = isUtf16)
+                .also { value -> cachedClasses = value }
+
+
+    /**
+     * Copies all values out of native tag, so the copy can be kept after the tag was delivered.
+     * @return Detached copy of the tag, this tag when it's detached already.
+     * @throws IllegalStateException when native tag is no longer valid and some value was not read.
+     * @since 1.0.0
+     */
+    fun detach(): TagInfo {
+        if (isDetached) {
+            return this
+        }
+        return TagInfo(
+            tag = tag,
+            body = body,
+            attributes = attributes,
+            classes = classes,
+            isSingle = isSingle,
+        )
+    }
+
+
+    private fun requireNativeTag(): Long {
+        val tag = nativeTag
+        check(value = tag != 0L) {
+            "TagInfo is valid only while it's delivered to callback, use detach() to keep it"
+        }
+        return tag
+    }
+
+
+    /**
+     * Detached tags are equal by their values. Tag backed by native tag is equal only to itself, its
+     * values may be not available anymore and comparing them would read them from native tag.
+     */
+    override fun equals(other: Any?): Boolean {
+        if (this === other) {
+            return true
+        }
+        return other is TagInfo
+                && isDetached
+                && other.isDetached
+                && tag == other.tag
+                && body == other.body
+                && attributes == other.attributes
+                && classes == other.classes
+                && isSingle == other.isSingle
+    }
+
+
+    override fun hashCode(): Int {
+        if (!isDetached) {
+            return System.identityHashCode(this)
+        }
+        var result = tag.hashCode()
+        result = 31 * result + body.hashCode()
+        result = 31 * result + attributes.hashCode()
+        result = 31 * result + classes.hashCode()
+        result = 31 * result + isSingle.hashCode()
+        return result
+    }
+
+
+    /**
+     * Tag body removed from string because it could mess up readability. Values which were not read
+     * while native tag was valid are printed as &lt;invalidated&gt;.
      */
     override fun toString(): String {
+        if (!isDetached && nativeTag == 0L) {
+            val invalidated = "<invalidated>"
+            return "TagInfo(tag='${cachedTag ?: invalidated}', " +
+                    "attributes=${cachedAttributes ?: invalidated}, " +
+                    "classes=${cachedClasses ?: invalidated}, isSingle=$isSingle)"
+        }
         return "TagInfo(tag='$tag', attributes=$attributes, classes=$classes, isSingle=$isSingle)"
     }
-}
\ No newline at end of file
+
+
+    @FastNative
+    private external fun nativeGetTag(nativeTag: Long, isUtf16: Boolean): String
+
+
+    @FastNative
+    private external fun nativeGetBody(nativeTag: Long, isUtf16: Boolean): String
+
+
+    @FastNative
+    private external fun nativeGetAttributes(nativeTag: Long, isUtf16: Boolean): Map<String, String>
+
+
+    @FastNative
+    private external fun nativeGetClasses(nativeTag: Long, isUtf16: Boolean): List<String>
+}
@@ -0,0 +1,118 @@
+///
+/// Checks that memory held by HtmlIterator for state of the document depends on nesting depth of
+/// the content, not on its length. Shallow documents with different count of pair tags have to
+/// leave the arena with the same capacity, both when values of tags are read and when they are not.
+///
+
+#include <cstdio>
+#include <string>
+#include "HtmlIterator.h"
+
+
+constexpr size_t SMALL_TAGS_COUNT = 1000;
+constexpr size_t BIG_TAGS_COUNT = 100000;
+
+
+/**
+ * Counts tags and reads their classes and attributes when <code>isReadingValues</code> is true, so
+ * lazily parsed values are allocated too.
+ */
+class ReadingCallback : public HtmlIteratorCallback {
+
+public:
+    bool isReadingValues;
+    size_t count = 0;
+
+
+    explicit ReadingCallback(bool isReadingValues) : isReadingValues(isReadingValues) {
+    }
+
+
+    void onContentText(std::string &text) override {
+    }
+
+
+    void onSingleTag(TagInfo &tag) override {
+    }
+
+
+    void onScript(TagInfo &tag) override {
+    }
+
+
+    bool onPairTag(
+            TagInfo &tag,
+            uint64_t openingTagStartIndex,
+            uint64_t openingTagEndIndex,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+        count += 1;
+        if (isReadingValues) {
+            count += tag.getClasses().size() + tag.getOutMap().size();
+        }
+        return true;
+    }
+
+
+    void onLeavingPairTag(
+            TagInfo &tag,
+            uint64_t closingTagStartIndex,
+            uint64_t closingTagEndIndex
+    ) override {
+    }
+};
+
+
+/**
+ * @return Document with tagsCount pair tags of depth 2, every tag has classes and attributes which
+ * don't fit into inline slots of TagAttributes.
+ */
+std::string createShallowDocument(size_t tagsCount) {
+    std::string document = "<html><body>";
+    for (size_t i = 0; i < tagsCount; i++) {
+        document += "<div class=\"a b c d e\" id=\"x\" data-a=\"1\" data-b=\"2\" data-c=\"3\" "
+                    "data-d=\"4\" data-e=\"5\"><span>text</span></div>";
+    }
+    document += "</body></html>";
+    return document;
+}
+
+
+/**
+ * @return Arena capacity after whole document was iterated.
+ */
+size_t iterate(const std::string &document, bool isReadingValues) {
+    HtmlIterator iterator;
+    ReadingCallback callback(isReadingValues);
+    iterator.setCallback(&callback);
+    iterator.setContent(std::string(document));
+    iterator.iterate();
+    return iterator.getArenaCapacity();
+}
+
+
+int main() {
+    std::string smallDocument = createShallowDocument(SMALL_TAGS_COUNT);
+    std::string bigDocument = createShallowDocument(BIG_TAGS_COUNT);
+    int failuresCount = 0;
+
+    for (bool isReadingValues: {false, true}) {
+        size_t smallCapacity = iterate(smallDocument, isReadingValues);
+        size_t bigCapacity = iterate(bigDocument, isReadingValues);
+        if (bigCapacity != smallCapacity) {
+            std::fprintf(
+                    stderr,
+                    "Arena grows with count of tags, isReadingValues: %d, %zu tags: %zu B, "
+                    "%zu tags: %zu B\n",
+                    isReadingValues,
+                    SMALL_TAGS_COUNT,
+                    smallCapacity,
+                    BIG_TAGS_COUNT,
+                    bigCapacity
+            );
+            failuresCount += 1;
+        }
+    }
+    return failuresCount == 0 ? 0 : 1;
+}